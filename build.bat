@@ -40,4 +40,8 @@ del /Q *.obj
 )
 
 cl.exe %compilerFlags% %warnings% %includes% ../source/Main.cpp /link %linkerFlags% %rayname%.lib %linkerLibs%
+REM Headless benchmark, simulation only (no raylib link needed)
+cl.exe %compilerFlags% %warnings% %includes% ../source/Bench.cpp /link /OUT:Bench.exe /INCREMENTAL
+REM Offline PNG -> QOI sprite cooker
+cl.exe %compilerFlags% %warnings% %includes% ../source/Cook.cpp /link /OUT:Cook.exe /INCREMENTAL
 popd
\ No newline at end of file
@@ -0,0 +1,31 @@
+#!/bin/sh
+# Headless targets for Linux / CI machines without a display.
+# The game itself is built on Windows with build.bat.
+
+set -e
+
+warnings="-Wall -Wextra -Wno-unused-parameter -Wno-unused-variable -Wno-missing-field-initializers"
+includes="-I ../external/raylib/"
+compilerFlags="-std=c++20 -ffast-math -fno-rtti -pthread"
+
+case "$1" in
+	-Release)
+		echo "[[ release build ]]"
+		compilerFlags="$compilerFlags -O2 -DNDEBUG"
+		;;
+	""|-Debug)
+		echo "[[ debug build ]]"
+		compilerFlags="$compilerFlags -O0 -g -D_DEBUG"
+		;;
+	*)
+		echo "usage: build.sh [-Debug|-Release]"
+		exit 1
+		;;
+esac
+
+mkdir -p build
+cd build
+
+c++ $compilerFlags $warnings $includes ../source/Bench.cpp -o Bench
+# Offline PNG -> QOI sprite cooker
+c++ $compilerFlags $warnings $includes ../source/Cook.cpp -o Cook
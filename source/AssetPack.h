@@ -0,0 +1,183 @@
+#pragma once
+
+#include <span>
+#include <string_view>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+
+#if defined(_WIN32)
+#if !defined(_WINDOWS_)
+// <windows.h> cannot sit next to raylib.h (CloseWindow, Rectangle, ...), so
+// only what is used here, with the same types windows.h declares them with
+extern "C" {
+	__declspec(dllimport) void* __stdcall CreateFileA(const char*, unsigned long, unsigned long, void*, unsigned long, unsigned long, void*);
+	__declspec(dllimport) unsigned long __stdcall GetFileSize(void*, unsigned long*);
+	__declspec(dllimport) void* __stdcall CreateFileMappingA(void*, void*, unsigned long, unsigned long, unsigned long, const char*);
+	__declspec(dllimport) void* __stdcall MapViewOfFile(void*, unsigned long, unsigned long, unsigned long, size_t);
+	__declspec(dllimport) int __stdcall UnmapViewOfFile(const void*);
+	__declspec(dllimport) int __stdcall CloseHandle(void*);
+}
+#endif
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// --- ASSET PACK ---
+// Every asset in one file, mapped read-only: a header, an index sorted by
+// name hash, the names, then the blobs, each starting on a PACK_ALIGN
+// boundary. A lookup is a binary search over the index, and the data is used
+// in place from the mapping, without reads or copies. Cook --pack writes it.
+// Native byte order, like snapshots.
+
+inline constexpr char PACK_MAGIC[4] = { 'A', 'P', 'A', 'K' };
+inline constexpr uint32_t PACK_VERSION = 1;
+inline constexpr size_t PACK_ALIGN = 64;
+
+struct PackHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t count;       // index entries
+	uint32_t namesSize;   // bytes of names after the index
+};
+
+struct PackEntry {
+	uint64_t hash;        // PackHash of the name
+	uint64_t offset;      // of the blob, from the start of the file
+	uint64_t size;
+	uint32_t name;        // offset into the names
+	uint32_t nameLength;
+};
+
+// FNV-1a
+inline uint64_t PackHash(std::string_view name) {
+	uint64_t h = 0xcbf29ce484222325ull;
+	for (char c : name) {
+		h = (h ^ static_cast<uint8_t>(c)) * 0x100000001b3ull;
+	}
+	return h;
+}
+
+class AssetPack {
+public:
+	AssetPack() = default;
+	~AssetPack() {
+		Close();
+	}
+	AssetPack(const AssetPack&) = delete;
+	AssetPack& operator=(const AssetPack&) = delete;
+
+	// Maps the file and checks that the index stays inside it; false (and
+	// closed) when it is missing or not a pack of this version
+	bool Open(const char* path) {
+		Close();
+		if (!Map(path)) return false;
+		PackHeader header;
+		if (size < sizeof(header)) return Fail();
+		memcpy(&header, data, sizeof(header));
+		const size_t indexEnd = sizeof(header) + static_cast<size_t>(header.count) * sizeof(PackEntry);
+		if (memcmp(header.magic, PACK_MAGIC, 4) != 0 || header.version != PACK_VERSION ||
+			indexEnd > size || header.namesSize > size - indexEnd) return Fail();
+		index = { reinterpret_cast<const PackEntry*>(data + sizeof(header)), header.count };
+		names = reinterpret_cast<const char*>(data + indexEnd);
+		for (const PackEntry& e : index) {
+			if (e.offset > size || e.size > size - e.offset ||
+				e.name > header.namesSize || e.nameLength > header.namesSize - e.name) return Fail();
+		}
+		return true;
+	}
+
+	void Close() {
+		if (data) Unmap();
+		data = nullptr;
+		size = 0;
+		index = {};
+		names = nullptr;
+	}
+
+	bool IsOpen() const {
+		return data != nullptr;
+	}
+
+	size_t Count() const {
+		return index.size();
+	}
+
+	// The asset's bytes inside the mapping, empty when it is not in the pack
+	std::span<const uint8_t> Find(std::string_view name) const {
+		const uint64_t hash = PackHash(name);
+		auto e = std::lower_bound(index.begin(), index.end(), hash, [](const PackEntry& a, uint64_t h) { return a.hash < h; });
+		for (; e != index.end() && e->hash == hash; ++e) {
+			if (std::string_view(names + e->name, e->nameLength) == name) return { data + e->offset, static_cast<size_t>(e->size) };
+		}
+		return {};
+	}
+
+private:
+	bool Fail() {
+		Close();
+		return false;
+	}
+
+#if defined(_WIN32)
+	bool Map(const char* path) {
+		void* const invalid = reinterpret_cast<void*>(static_cast<intptr_t>(-1));
+		file = CreateFileA(path, 0x80000000ul /* GENERIC_READ */, 1 /* FILE_SHARE_READ */, nullptr,
+			3 /* OPEN_EXISTING */, 0x80 /* FILE_ATTRIBUTE_NORMAL */, nullptr);
+		if (file == invalid) {
+			file = nullptr;
+			return false;
+		}
+		unsigned long high = 0;
+		const unsigned long low = GetFileSize(file, &high);
+		size = static_cast<size_t>(static_cast<uint64_t>(high) << 32 | low);
+		mapping = size ? CreateFileMappingA(file, nullptr, 2 /* PAGE_READONLY */, 0, 0, nullptr) : nullptr;
+		void* view = mapping ? MapViewOfFile(mapping, 4 /* FILE_MAP_READ */, 0, 0, 0) : nullptr;
+		if (!view) {
+			Unmap();
+			return false;
+		}
+		data = static_cast<const uint8_t*>(view);
+		return true;
+	}
+
+	void Unmap() {
+		if (data) UnmapViewOfFile(data);
+		if (mapping) CloseHandle(mapping);
+		if (file) CloseHandle(file);
+		mapping = nullptr;
+		file = nullptr;
+	}
+
+	void* file = nullptr;
+	void* mapping = nullptr;
+#else
+	bool Map(const char* path) {
+		const int fd = open(path, O_RDONLY);
+		if (fd < 0) return false;
+		struct stat st;
+		void* view = MAP_FAILED;
+		if (fstat(fd, &st) == 0 && st.st_size > 0) {
+			size = static_cast<size_t>(st.st_size);
+			view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		}
+		close(fd);   // the mapping keeps the file
+		if (view == MAP_FAILED) return false;
+		data = static_cast<const uint8_t*>(view);
+		return true;
+	}
+
+	void Unmap() {
+		munmap(const_cast<uint8_t*>(data), size);
+	}
+#endif
+
+	const uint8_t* data = nullptr;
+	size_t size = 0;
+	std::span<const PackEntry> index;
+	const char* names = nullptr;
+};
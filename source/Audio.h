@@ -0,0 +1,253 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+
+#include <raymath.h>
+
+#include "Random.h"
+
+// --- AUDIO MIXER ---
+// Sound effects at a bounded cost, however many events fire. Every sound is
+// decoded (or synthesized) up front into a resident mono float buffer.
+// The game thread Triggers sounds during a frame; triggers of the same sound
+// merge into one, the loudest wins, and EndFrame hands at most one per sound
+// to the mixer through a single-producer ring, no locks. The mixer runs on
+// the audio device's thread and plays them on a fixed pool of voices: when
+// every voice is busy the least audible one (priority times gain, fading as
+// it plays out) is stolen if the newcomer beats it, otherwise the newcomer is
+// dropped.
+// Like the particles, none of this feeds back into the simulation.
+
+enum class SoundId : uint8_t { LASER, BULLET, MISSILE, GRENADE, EXPLOSION, BLAST, ASTEROID, COUNT, NONE = COUNT };
+
+inline constexpr size_t C_SOUND_COUNT = static_cast<size_t>(SoundId::COUNT);
+
+// A synthesized effect: a tone sweeping from startHz to endHz mixed with
+// low-passed noise, under an exponential decay
+struct SoundPatch {
+	float seconds;
+	float startHz, endHz;
+	float tone, noise;    // mix levels
+	float smoothing;      // noise low-pass, 0 for none up to just under 1
+	float decay;          // per second
+};
+
+struct SoundInfo {
+	const char* file;     // replaces the patch when it can be read
+	uint8_t priority;     // what survives voice stealing, higher first
+	float gain;
+	SoundPatch patch;
+};
+
+inline constexpr SoundInfo soundInfos[C_SOUND_COUNT] = {
+	/* LASER     */ { "laser.wav",     1, 0.25f, { 0.12f, 1800.f,  300.f, 1.0f, 0.0f, 0.0f,  25.f } },
+	/* BULLET    */ { "bullet.wav",    1, 0.20f, { 0.05f,  900.f,  600.f, 0.6f, 0.4f, 0.3f,  60.f } },
+	/* MISSILE   */ { "missile.wav",   2, 0.35f, { 0.30f,  200.f,  500.f, 0.4f, 0.6f, 0.8f,   8.f } },
+	/* GRENADE   */ { "grenade.wav",   2, 0.35f, { 0.10f,  150.f,   60.f, 1.0f, 0.2f, 0.5f,  30.f } },
+	/* EXPLOSION */ { "explosion.wav", 4, 0.60f, { 0.60f,   80.f,   30.f, 0.3f, 1.0f, 0.9f,   6.f } },
+	/* BLAST     */ { "blast.wav",     4, 0.70f, { 0.90f,   60.f,   25.f, 0.3f, 1.0f, 0.95f,  4.f } },
+	/* ASTEROID  */ { "asteroid.wav",  3, 0.45f, { 0.25f,   90.f,   50.f, 0.5f, 0.8f, 0.7f,  14.f } },
+};
+
+class Mixer {
+public:
+	static constexpr unsigned SAMPLE_RATE = 44100;
+	static constexpr size_t VOICES = 24;
+	static constexpr size_t QUEUE = 64;   // triggers on their way to the mixer, a power of two
+
+	// Since start. Dropped counts triggers the full queue turned away as well
+	// as the ones that lost out on a voice.
+	struct Stats {
+		uint64_t triggers, merged, inaudible;
+		uint64_t started, stolen, dropped;
+		unsigned voices;   // playing after the last Mix
+	};
+
+	static Mixer& Instance() {
+		static Mixer inst;
+		return inst;
+	}
+
+	// Replaces a sound's PCM (mono, SAMPLE_RATE); only while nothing is mixing
+	void SetSound(SoundId id, std::vector<float> samples) {
+		sounds[static_cast<size_t>(id)] = std::move(samples);
+	}
+
+	// Renders a sound's patch
+	void Synthesize(SoundId id) {
+		const SoundPatch& p = soundInfos[static_cast<size_t>(id)].patch;
+		const size_t n = static_cast<size_t>(p.seconds * SAMPLE_RATE);
+		std::vector<float> samples(n);
+		Rng rng(static_cast<uint64_t>(id), RngStream::AUDIO);
+		float phase = 0.f, noise = 0.f;
+		const float attack = 0.002f * SAMPLE_RATE;   // samples, no click at the start
+		for (size_t i = 0; i < n; i++) {
+			const float t = static_cast<float>(i) / SAMPLE_RATE;
+			const float hz = Lerp(p.startHz, p.endHz, static_cast<float>(i) / n);
+			phase += 2.f * PI * hz / SAMPLE_RATE;
+			if (phase > 2.f * PI) phase -= 2.f * PI;
+			noise = noise * p.smoothing + rng.Float(-1.f, 1.f) * (1.f - p.smoothing);
+			const float envelope = std::min(1.f, static_cast<float>(i) / attack) * expf(-p.decay * t);
+			samples[i] = (p.tone * sinf(phase) + p.noise * noise) * envelope;
+		}
+		SetSound(id, std::move(samples));
+	}
+
+	// Game thread: where the ears are; sounds fade out to nothing at range
+	void SetListener(Vector2 position, float range) {
+		listener = position;
+		hearing = range;
+	}
+
+	// Game thread: the sound, heard from position, starts with the next EndFrame
+	void Trigger(SoundId id, Vector2 position) {
+		if (id == SoundId::NONE) return;
+		triggers.fetch_add(1, std::memory_order_relaxed);
+		const SoundInfo& info = soundInfos[static_cast<size_t>(id)];
+		const float dx = position.x - listener.x;
+		const float distance = Vector2Distance(position, listener);
+		const float gain = info.gain * std::max(0.f, 1.f - distance / hearing);
+		if (gain <= 0.f) {
+			inaudible.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		Pending& p = pending[static_cast<size_t>(id)];
+		if (p.gain > 0.f) merged.fetch_add(1, std::memory_order_relaxed);
+		if (gain > p.gain) {
+			p.gain = gain;
+			p.pan = std::clamp(dx / hearing, -1.f, 1.f);
+		}
+	}
+
+	// Game thread, once per frame: passes this frame's triggers on
+	void EndFrame() {
+		uint32_t h = head.load(std::memory_order_relaxed);
+		const uint32_t t = tail.load(std::memory_order_acquire);
+		for (size_t s = 0; s < C_SOUND_COUNT; s++) {
+			Pending& p = pending[s];
+			if (p.gain <= 0.f) continue;
+			if (h - t < QUEUE) {
+				queue[h & (QUEUE - 1)] = { static_cast<SoundId>(s), p.gain, p.pan };
+				h++;
+			}
+			else {
+				dropped.fetch_add(1, std::memory_order_relaxed);
+			}
+			p = {};
+		}
+		head.store(h, std::memory_order_release);
+	}
+
+	// Audio thread: starts what was queued, then adds every playing voice into
+	// out, frames interleaved stereo float samples
+	void Mix(float* out, unsigned frames) {
+		const uint32_t h = head.load(std::memory_order_acquire);
+		uint32_t t = tail.load(std::memory_order_relaxed);
+		for (; t != h; t++) {
+			Start(queue[t & (QUEUE - 1)]);
+		}
+		tail.store(t, std::memory_order_release);
+
+		std::fill(out, out + 2 * static_cast<size_t>(frames), 0.f);
+		unsigned playing = 0;
+		for (Voice& v : voices) {
+			if (!v.samples) continue;
+			const uint32_t n = std::min<uint32_t>(frames, v.length - v.at);
+			const float* src = v.samples + v.at;
+			for (uint32_t i = 0; i < n; i++) {
+				out[2 * i] += src[i] * v.left;
+				out[2 * i + 1] += src[i] * v.right;
+			}
+			v.at += n;
+			if (v.at == v.length) v.samples = nullptr;
+			else playing++;
+		}
+		for (size_t i = 0; i < 2 * static_cast<size_t>(frames); i++) {
+			out[i] = std::clamp(out[i], -1.f, 1.f);
+		}
+		voiceCount.store(playing, std::memory_order_relaxed);
+	}
+
+	Stats GetStats() const {
+		return {
+			triggers.load(std::memory_order_relaxed), merged.load(std::memory_order_relaxed),
+			inaudible.load(std::memory_order_relaxed), started.load(std::memory_order_relaxed),
+			stolen.load(std::memory_order_relaxed), dropped.load(std::memory_order_relaxed),
+			voiceCount.load(std::memory_order_relaxed)
+		};
+	}
+
+private:
+	struct Pending {
+		float gain = 0.f;   // 0 for not triggered this frame
+		float pan = 0.f;
+	};
+
+	struct Queued {
+		SoundId id;
+		float gain;
+		float pan;          // -1 left to 1 right
+	};
+
+	struct Voice {
+		const float* samples = nullptr;   // null when free
+		uint32_t length = 0, at = 0;
+		float left = 0.f, right = 0.f;
+		float audibility = 0.f;           // priority * gain when it started
+
+		// What stealing compares: the audibility, less for what has played
+		float Remaining() const {
+			return audibility * static_cast<float>(length - at) / static_cast<float>(length);
+		}
+	};
+
+	void Start(const Queued& q) {
+		const SoundInfo& info = soundInfos[static_cast<size_t>(q.id)];
+		const std::vector<float>& pcm = sounds[static_cast<size_t>(q.id)];
+		if (pcm.empty()) return;
+		const float audibility = info.priority * q.gain;
+		Voice* slot = nullptr;
+		for (Voice& v : voices) {
+			if (!v.samples) {
+				slot = &v;
+				break;
+			}
+			if (!slot || v.Remaining() < slot->Remaining()) slot = &v;
+		}
+		if (slot->samples) {
+			if (slot->Remaining() >= audibility) {
+				dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			stolen.fetch_add(1, std::memory_order_relaxed);
+		}
+		// Equal-power pan
+		const float angle = (q.pan + 1.f) * PI * 0.25f;
+		*slot = { pcm.data(), static_cast<uint32_t>(pcm.size()), 0, q.gain * cosf(angle), q.gain * sinf(angle), audibility };
+		started.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	std::array<std::vector<float>, C_SOUND_COUNT> sounds;
+
+	// Game thread
+	Vector2 listener = { 0, 0 };
+	float hearing = 1.f;
+	std::array<Pending, C_SOUND_COUNT> pending = {};
+
+	// Game thread to mixer
+	std::array<Queued, QUEUE> queue = {};
+	std::atomic<uint32_t> head{ 0 };
+	std::atomic<uint32_t> tail{ 0 };
+
+	// Mixer
+	std::array<Voice, VOICES> voices = {};
+
+	std::atomic<uint64_t> triggers{ 0 }, merged{ 0 }, inaudible{ 0 };
+	std::atomic<uint64_t> started{ 0 }, stolen{ 0 }, dropped{ 0 };
+	std::atomic<unsigned> voiceCount{ 0 };
+};
@@ -0,0 +1,672 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <chrono>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+#include "World.h"
+#include "Replay.h"
+#include "HeapCheck.h"
+#include "Audio.h"
+
+// --- HEADLESS BENCHMARK ---
+// Drives World::Step with scripted input, no window or GPU required.
+// Usage: Bench [--scenario name|all|stress] [--frames N] [--dt seconds] [--seed N] [--max-asteroids N]
+//              [--asteroids N] [--projectiles N] [--invulnerable] [--sweep] [--kernels] [--snapshots] [--audio]
+//              [--threads N] [--scaling] [--trace file.json] [--csv file.csv]
+//              [--replay file.rep] [--json results.json] [--tuning file.txt]
+// The state column hashes the final world; it must not change with --threads.
+// startMs is the world's construction plus its first step, the bench's take on
+// a game's time to the first interactive frame.
+// --json writes every row (plus the build's kernel dispatch) for comparing builds.
+
+// --- MEMORY COUNTERS ---
+// Allocations per frame come from HeapCheck.h, which counts every operator new.
+
+// High-water mark of the whole process so far, in MiB
+static double PeakRssMb() {
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS pmc;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return 0.0;
+	return pmc.PeakWorkingSetSize / (1024.0 * 1024.0);
+#else
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0.0;
+#if defined(__APPLE__)
+	return usage.ru_maxrss / (1024.0 * 1024.0);  // bytes
+#else
+	return usage.ru_maxrss / 1024.0;             // KiB
+#endif
+#endif
+}
+
+// --- SCENARIOS ---
+
+struct Scenario {
+	const char* name;
+	const char* description;
+	InputState (*script)(const World& world, int frame);
+	// Stress scenarios only run when named or with --scenario stress. Their
+	// populations are kept topped up (--asteroids / --projectiles override
+	// them) and the ship cannot die, it sits inside the swarm.
+	bool stress = false;
+	size_t asteroids = 0;
+	size_t projectiles = 0;
+	AsteroidShape shape = AsteroidShape::RANDOM;
+	size_t particles = 0;
+	// Arena side in views, and asteroids scattered over it at the start
+	int arena = 1;
+	size_t arenaAsteroids = 0;
+};
+
+// Respawn as soon as the player dies so every scenario keeps shooting
+static InputState KeepAlive(const World& world) {
+	InputState in;
+	if (!world.GetPlayer().IsAlive()) in.pressed |= IN_RESTART;
+	return in;
+}
+
+static InputState ScriptIdle(const World& world, int frame) {
+	return KeepAlive(world);
+}
+
+static InputState ScriptLaser(const World& world, int frame) {
+	InputState in = KeepAlive(world);
+	in.held |= IN_FIRE;
+	return in;
+}
+
+static InputState ScriptBullets(const World& world, int frame) {
+	InputState in = KeepAlive(world);
+	if (world.GetCurrentWeapon() != WeaponType::BULLET) in.pressed |= IN_NEXT_WEAPON;
+	in.held |= IN_FIRE;
+	return in;
+}
+
+static InputState ScriptMissiles(const World& world, int frame) {
+	InputState in = KeepAlive(world);
+	if (world.GetCurrentWeapon() != WeaponType::MISSILE) in.pressed |= IN_NEXT_WEAPON;
+	if (frame % 20 == 19) in.pressed |= IN_DETONATE;
+	in.held |= IN_FIRE;
+	return in;
+}
+
+static InputState ScriptGrenades(const World& world, int frame) {
+	InputState in = KeepAlive(world);
+	if (world.GetCurrentCharacter() != Character::GMAIL) in.pressed |= IN_NEXT_CHARACTER;
+	in.held |= IN_FIRE | (frame & 64 ? IN_LEFT : IN_RIGHT);
+	return in;
+}
+
+// Every weapon and character in turn, detonating now and then
+static InputState ScriptMixed(const World& world, int frame) {
+	InputState in = KeepAlive(world);
+	if (frame % 240 == 239) in.pressed |= IN_NEXT_WEAPON;
+	if (frame % 720 == 719) in.pressed |= IN_NEXT_CHARACTER;
+	if (frame % 30 == 29) in.pressed |= IN_DETONATE;
+	in.held |= IN_FIRE | (frame & 128 ? IN_UP : IN_DOWN);
+	return in;
+}
+
+// Flies across a large arena, turning to the next of eight headings every four seconds
+static InputState ScriptRoam(const World& world, int frame) {
+	static constexpr uint32_t headings[] = {
+		IN_RIGHT, IN_RIGHT | IN_DOWN, IN_DOWN, IN_DOWN | IN_LEFT, IN_LEFT, IN_LEFT | IN_UP, IN_UP, IN_UP | IN_RIGHT,
+	};
+	InputState in = KeepAlive(world);
+	in.held |= IN_FIRE | headings[(frame / 480) % 8];
+	return in;
+}
+
+static const Scenario scenarios[] = {
+	{ "idle",          "asteroids only",                           ScriptIdle },
+	{ "laser",         "hold fire with the laser",                 ScriptLaser },
+	{ "bullets",       "hold fire with bullets",                   ScriptBullets },
+	{ "missiles",      "missiles, detonated every 20 frames",      ScriptMissiles },
+	{ "grenades",      "gmail grenade chains while strafing",      ScriptGrenades },
+	{ "asteroids-1k",  "1k asteroids, no shooting",                ScriptIdle,     true, 1'000 },
+	{ "asteroids-10k", "10k asteroids, no shooting",               ScriptIdle,     true, 10'000 },
+	{ "asteroids-100k","100k asteroids, no shooting",              ScriptIdle,     true, 100'000 },
+	{ "laser-spam",    "laser into 10k asteroids",                 ScriptLaser,    true, 10'000 },
+	{ "grenade-chain", "grenade chains into 10k asteroids",        ScriptGrenades, true, 10'000 },
+	{ "geeble",        "10k textured Geebles under bullet fire",   ScriptBullets,  true, 10'000, 0, AsteroidShape::GEEBLE },
+	{ "mixed",         "every weapon, 5k asteroids, 20k bullets",  ScriptMixed,    true, 5'000, 20'000 },
+	{ "particles-100k","100k live particles over 1k asteroids",    ScriptIdle,     true, 1'000, 0, AsteroidShape::RANDOM, 100'000 },
+	{ "open-world",    "300k asteroids over 100x100 views, roaming", ScriptRoam,   true, 0, 0, AsteroidShape::RANDOM, 0, 100, 300'000 },
+};
+
+struct Options {
+	std::string scenario = "all";
+	int frames = 3600;
+	float dt = World::C_FIXED_DT;
+	unsigned seed = 1234;
+	size_t maxAsteroids = 150;
+	size_t population = 0;  // keep at least this many asteroids alive, bypassing the spawn timer
+	size_t projectilePopulation = 0; // same for stray bullets crossing the screen
+	bool invulnerable = false;
+	bool sweep = false;     // rerun each scenario with growing populations
+	bool kernels = false;   // time the integration kernels in isolation instead
+	bool snapshots = false; // time world snapshots and the rewind buffer instead
+	bool audio = false;     // time the sound mixer under growing trigger rates instead
+	unsigned threads = 1;   // job system size, 0 for one per hardware thread
+	bool scaling = false;   // rerun each scenario at every threadCounts entry
+	std::string trace;      // Chrome trace of the whole run
+	std::string csv;        // per-frame zone times of the whole run
+	std::string replay;     // play a recording from the game instead of the scenarios
+	std::string json;       // machine-readable copy of every row
+	Tuning tuning;          // weapon and ship numbers, --tuning overrides the defaults
+};
+
+// One printed row
+struct Result {
+	std::string label;
+	double phaseMs[static_cast<int>(World::Phase::COUNT)];
+	double frameMs, frameP99Ms;
+	double startMs;          // construction and first step
+	double allocsPerFrame, bytesPerFrame;
+	double peakRssMb;
+	size_t peakProjectiles, peakAsteroids;
+	uint32_t checksum;
+};
+static std::vector<Result> results;
+static double firstStepMs = -1.0;   // process start to the end of the run's first step
+
+static const size_t sweepPopulations[] = { 150, 500, 1000, 2500, 5000, 10'000 };
+static const unsigned threadCounts[] = { 1, 2, 4, 8, 16 };
+
+// Prints one row and returns it; frame times cover World::Step only, not the top-ups
+static Result RunScenario(const Scenario& sc, const Options& opt) {
+	const size_t population = opt.population ? opt.population : sc.asteroids;
+	const size_t projectilePopulation = opt.projectilePopulation ? opt.projectilePopulation : sc.projectiles;
+	World::Config config;
+	config.seed = opt.seed;
+	config.maxAsteroids = std::max(opt.maxAsteroids, population);
+	config.invulnerable = opt.invulnerable || sc.stress;
+	config.threads = opt.threads;
+	config.arenaWidth = config.width * sc.arena;
+	config.arenaHeight = config.height * sc.arena;
+	config.arenaAsteroids = sc.arenaAsteroids;
+	config.tuning = opt.tuning;
+	const auto constructed = std::chrono::steady_clock::now();
+	World world(config);
+	Rng rng(opt.seed, RngStream::BENCH);
+	double startMs = 0.0;
+	std::vector<float> spawn;
+
+	constexpr int phaseCount = static_cast<int>(World::Phase::COUNT);
+	double phaseTotal[phaseCount] = {};
+	size_t peakProjectiles = 0, peakAsteroids = 0;
+	std::vector<double> frameMs;
+	frameMs.reserve(opt.frames);
+	uint64_t allocs = 0, bytes = 0;
+
+	for (int frame = 0; frame < opt.frames; frame++) {
+		while (world.GetAsteroids().Size() < population) {
+			world.SpawnAsteroid(sc.shape);
+		}
+		// Topped up in one batch: x, y and heading per projectile, all over the view
+		const Vector2 origin = world.GetView().min;
+		if (world.GetProjectiles().Size() < projectilePopulation) {
+			const size_t missing = projectilePopulation - world.GetProjectiles().Size();
+			spawn.resize(3 * missing);
+			rng.Fill(spawn.data(), spawn.size(), 0.f, 1.f);
+			const float w = static_cast<float>(config.width), h = static_cast<float>(config.height);
+			for (size_t i = 0; i < missing; i++) {
+				const float ang = spawn[3 * i + 2] * 2 * PI;
+				world.SpawnProjectile(WeaponType::BULLET, { origin.x + spawn[3 * i] * w, origin.y + spawn[3 * i + 1] * h },
+					{ cosf(ang) * 440.f, sinf(ang) * 440.f });
+			}
+		}
+		// Debris bursts all over the view
+		while (world.GetParticles().Size() < sc.particles) {
+			const int missing = static_cast<int>(std::min<size_t>(sc.particles - world.GetParticles().Size(), 1000));
+			const Vector2 at = { origin.x + rng.Float(0.f, static_cast<float>(config.width)), origin.y + rng.Float(0.f, static_cast<float>(config.height)) };
+			world.GetParticles().Burst(C_EMIT_DEBRIS, at, { 0, 0 }, 0.f, missing);
+		}
+		const InputState in = sc.script(world, frame);
+		const uint64_t allocsBefore = HeapCheck::Allocations();
+		const uint64_t bytesBefore = HeapCheck::Bytes();
+		auto start = std::chrono::steady_clock::now();
+		world.Step(in, opt.dt);
+		std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+		allocs += HeapCheck::Allocations() - allocsBefore;
+		bytes += HeapCheck::Bytes() - bytesBefore;
+		frameMs.push_back(ms.count());
+		if (frame == 0) {
+			const std::chrono::duration<double, std::milli> start = std::chrono::steady_clock::now() - constructed;
+			startMs = start.count();
+			if (firstStepMs < 0.0) firstStepMs = MsSinceProcessStart();
+		}
+		PROFILE_END_FRAME();
+		for (int p = 0; p < phaseCount; p++) {
+			phaseTotal[p] += world.GetPhaseMs(static_cast<World::Phase>(p));
+		}
+		peakProjectiles = std::max(peakProjectiles, world.GetProjectiles().Size());
+		peakAsteroids = std::max(peakAsteroids, world.GetAsteroids().Size());
+	}
+
+	Result r;
+	char label[48];
+	int len = snprintf(label, sizeof(label), "%s", sc.name);
+	if (opt.population > 0 || opt.projectilePopulation > 0) len += snprintf(label + len, sizeof(label) - len, "/%zu/%zu", population, projectilePopulation);
+	if (opt.threads != 1) snprintf(label + len, sizeof(label) - len, "/%ut", world.GetThreadCount());
+	r.label = label;
+	double total = 0.0;
+	for (double ms : frameMs) {
+		total += ms;
+	}
+	for (int p = 0; p < phaseCount; p++) {
+		r.phaseMs[p] = phaseTotal[p] / opt.frames;
+	}
+	r.frameMs = total / opt.frames;
+	std::sort(frameMs.begin(), frameMs.end());
+	r.frameP99Ms = frameMs[std::min(frameMs.size() - 1, frameMs.size() * 99 / 100)];
+	r.startMs = startMs;
+	r.allocsPerFrame = static_cast<double>(allocs) / opt.frames;
+	r.bytesPerFrame = static_cast<double>(bytes) / opt.frames;
+	r.peakRssMb = PeakRssMb();
+	r.peakProjectiles = peakProjectiles;
+	r.peakAsteroids = peakAsteroids;
+	r.checksum = world.Checksum();
+
+	printf("%-18s", label);
+	for (int p = 0; p < phaseCount; p++) {
+		printf(" %12.4f", r.phaseMs[p]);
+	}
+	printf(" %12.4f %12.4f %9.3f %9.1f %8.1f %8zu %8zu %08x\n", r.frameMs, r.frameP99Ms, r.startMs, r.allocsPerFrame, r.peakRssMb,
+		r.peakProjectiles, r.peakAsteroids, r.checksum);
+	results.push_back(r);
+	return r;
+}
+
+// Same scenario at every thread count; defaults to a crowded screen if no population was given
+static void RunScaling(const Scenario& sc, Options opt) {
+	if (!sc.stress && opt.population == 0 && opt.projectilePopulation == 0) {
+		opt.population = 10'000;
+		opt.projectilePopulation = 100'000;
+	}
+	opt.invulnerable = true;
+	double single = 0.0;
+	for (unsigned t : threadCounts) {
+		opt.threads = t;
+		const double ms = RunScenario(sc, opt).frameMs;
+		if (t == 1) single = ms;
+		printf("%18s speedup %.2fx\n", "", single / ms);
+	}
+}
+
+// Scalar vs AVX2 integration over n entities, ns per entity
+static void RunKernels() {
+	static const size_t counts[] = { 1'000, 10'000, 100'000, 1'000'000 };
+	printf("integration kernels, dispatch picks %s\n", Kernels::IntegrateName());
+	printf("%10s %14s %14s %10s\n", "entities", "scalar ns/ent", "avx2 ns/ent", "speedup");
+	for (size_t n : counts) {
+		std::vector<float> transform(3 * n), physics(3 * n), radius(n);
+		std::vector<uint8_t> mask((n + 7) / 8);
+		Rng rng(0, RngStream::BENCH);
+		rng.Fill(transform.data(), transform.size(), 0.f, 800.f);
+		rng.Fill(physics.data(), physics.size(), -1.f, 1.f);
+		std::fill(radius.begin(), radius.end(), 16.f);
+		const int reps = static_cast<int>(std::max<size_t>(10, 20'000'000 / n));
+		auto time = [&](Kernels::IntegrateFn fn) {
+			auto start = std::chrono::steady_clock::now();
+			for (int r = 0; r < reps; r++) {
+				fn(transform.data(), physics.data(), radius.data(), n, 1.f / 60.f, 0.f, 0.f, 800.f, 800.f, mask.data());
+			}
+			std::chrono::duration<double, std::nano> ns = std::chrono::steady_clock::now() - start;
+			return ns.count() / (static_cast<double>(reps) * n);
+		};
+		const double scalar = time(Kernels::IntegrateScalar);
+#if KERNELS_X86
+		if (Kernels::hasAVX2) {
+			const double avx2 = time(Kernels::IntegrateAVX2);
+			printf("%10zu %14.3f %14.3f %9.2fx\n", n, scalar, avx2, scalar / avx2);
+			continue;
+		}
+#endif
+		printf("%10zu %14.3f %14s %10s\n", n, scalar, "n/a", "-");
+	}
+}
+
+// World::Save / Load and RewindBuffer Push / Back at growing populations,
+// microseconds per call. The second of two trips through the ring is timed,
+// once every buffer has reached its size; allocations are those four calls'.
+static void RunSnapshots(const Options& opt) {
+	static const size_t counts[] = { 1'000, 10'000, 100'000 };
+	constexpr size_t history = 64;
+	printf("%10s %10s %10s %10s %10s %10s %10s %8s\n", "entities", "KB", "save us", "load us", "push us", "back us", "delta KB", "allocs");
+	for (size_t n : counts) {
+		World::Config config;
+		config.seed = opt.seed;
+		config.maxAsteroids = n;
+		config.invulnerable = true;
+		config.threads = opt.threads;
+		config.tuning = opt.tuning;
+		World world(config);
+		while (world.GetAsteroids().Size() < n) {
+			world.SpawnAsteroid(AsteroidShape::RANDOM);
+		}
+		// A pool that holds every delta whole
+		std::vector<uint8_t> state;
+		world.Save(state);
+		RewindBuffer rewind;
+		rewind.Init(history, history * state.size() * 2);
+		double saveUs = 0.0, loadUs = 0.0, pushUs = 0.0, backUs = 0.0;
+		uint64_t allocs = 0;
+		int saves = 0, loads = 0;
+		for (int pass = 0; pass < 2; pass++) {
+			for (size_t k = 0; k < history; k++) {
+				while (world.GetAsteroids().Size() < n) {
+					world.SpawnAsteroid(AsteroidShape::RANDOM);
+				}
+				for (int s = 0; s < 4; s++) {
+					world.Step(ScriptBullets(world, static_cast<int>(k) * 4 + s), World::C_FIXED_DT);
+				}
+				const uint64_t allocsBefore = HeapCheck::Allocations();
+				auto start = std::chrono::steady_clock::now();
+				world.Save(state);
+				auto saved = std::chrono::steady_clock::now();
+				rewind.Push(state);
+				auto pushed = std::chrono::steady_clock::now();
+				if (pass == 1) {
+					allocs += HeapCheck::Allocations() - allocsBefore;
+					saveUs += std::chrono::duration<double, std::micro>(saved - start).count();
+					pushUs += std::chrono::duration<double, std::micro>(pushed - saved).count();
+					saves++;
+				}
+			}
+			while (!rewind.Empty()) {
+				const uint64_t allocsBefore = HeapCheck::Allocations();
+				auto start = std::chrono::steady_clock::now();
+				world.Load(rewind.Head());
+				auto loaded = std::chrono::steady_clock::now();
+				const bool more = rewind.Back();
+				auto back = std::chrono::steady_clock::now();
+				if (pass == 1) {
+					allocs += HeapCheck::Allocations() - allocsBefore;
+					loadUs += std::chrono::duration<double, std::micro>(loaded - start).count();
+					backUs += std::chrono::duration<double, std::micro>(back - loaded).count();
+					loads++;
+				}
+				if (!more) break;
+			}
+			// Back at the oldest snapshot: start the next pass from there
+			rewind.Clear();
+		}
+		// One more round to see what the deltas weigh with a full ring
+		for (size_t k = 0; k < history; k++) {
+			world.Step(ScriptBullets(world, static_cast<int>(k)), World::C_FIXED_DT);
+			world.Save(state);
+			rewind.Push(state);
+		}
+		const double deltaKb = (rewind.Bytes() - rewind.Head().size()) / 1024.0 / std::max<size_t>(1, rewind.Size());
+		printf("%10zu %10.1f %10.2f %10.2f %10.2f %10.2f %10.1f %8llu\n", n, state.size() / 1024.0, saveUs / saves, loadUs / loads,
+			pushUs / saves, backUs / loads, deltaKb, static_cast<unsigned long long>(allocs));
+	}
+}
+
+// The mixer fed trigger counts from a handful to far more than the game makes,
+// at 60 frames a second: per-frame cost on the game thread (Trigger and
+// EndFrame) and on the audio thread (Mix), which stay flat as the count grows
+static void RunAudio(const Options& opt) {
+	static const int counts[] = { 1, 10, 100, 1'000, 10'000 };
+	constexpr int frames = 600;
+	constexpr unsigned samples = Mixer::SAMPLE_RATE / 60;
+	printf("%10s %10s %10s %8s %10s %10s %10s %8s\n", "triggers/f", "game us", "mix us", "voices", "merged/f", "stolen/f", "dropped/f", "allocs");
+	std::vector<float> out(2 * samples);
+	for (int n : counts) {
+		Mixer mixer;
+		for (size_t s = 0; s < C_SOUND_COUNT; s++) {
+			mixer.Synthesize(static_cast<SoundId>(s));
+		}
+		mixer.SetListener({ 400.f, 400.f }, 900.f);
+		Rng rng(opt.seed, RngStream::BENCH);
+		double gameUs = 0.0, mixUs = 0.0;
+		uint64_t voices = 0, allocs = 0;
+		for (int f = 0; f < frames; f++) {
+			const uint64_t allocsBefore = HeapCheck::Allocations();
+			auto start = std::chrono::steady_clock::now();
+			for (int k = 0; k < n; k++) {
+				const SoundId id = static_cast<SoundId>(rng.Next() % C_SOUND_COUNT);
+				mixer.Trigger(id, { rng.Float(0.f, 800.f), rng.Float(0.f, 800.f) });
+			}
+			mixer.EndFrame();
+			auto triggered = std::chrono::steady_clock::now();
+			mixer.Mix(out.data(), samples);
+			auto mixed = std::chrono::steady_clock::now();
+			allocs += HeapCheck::Allocations() - allocsBefore;
+			gameUs += std::chrono::duration<double, std::micro>(triggered - start).count();
+			mixUs += std::chrono::duration<double, std::micro>(mixed - triggered).count();
+			voices += mixer.GetStats().voices;
+		}
+		const Mixer::Stats stats = mixer.GetStats();
+		printf("%10d %10.2f %10.2f %8.1f %10.1f %10.2f %10.2f %8llu\n", n, gameUs / frames, mixUs / frames,
+			static_cast<double>(voices) / frames, static_cast<double>(stats.merged) / frames,
+			static_cast<double>(stats.stolen) / frames, static_cast<double>(stats.dropped) / frames,
+			static_cast<unsigned long long>(allocs));
+	}
+}
+
+// Replays a recording headless as fast as possible: frame time percentiles and
+// the final checksum, which must match the game's and every other build's
+static int RunReplay(const Options& opt) {
+	ReplayFile replay;
+	if (!replay.OpenRead(opt.replay.c_str())) {
+		fprintf(stderr, "cannot read replay %s\n", opt.replay.c_str());
+		return 1;
+	}
+	const ReplayHeader& header = replay.Header();
+	World::Config config;
+	header.Apply(config);
+	config.threads = opt.threads;
+	World world(config);
+
+	std::vector<double> frameMs;
+	frameMs.reserve(header.frameCount);
+	InputState in;
+	float dt = 0.f;
+	size_t peakProjectiles = 0, peakAsteroids = 0;
+	while (replay.Next(in, dt)) {
+		auto start = std::chrono::steady_clock::now();
+		world.Advance(in, dt);
+		std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+		frameMs.push_back(ms.count());
+		PROFILE_END_FRAME();
+		peakProjectiles = std::max(peakProjectiles, world.GetProjectiles().Size());
+		peakAsteroids = std::max(peakAsteroids, world.GetAsteroids().Size());
+	}
+
+	double total = 0.0;
+	for (double ms : frameMs) {
+		total += ms;
+	}
+	std::vector<double> sorted = frameMs;
+	std::sort(sorted.begin(), sorted.end());
+	auto pct = [&](double p) { return sorted.empty() ? 0.0 : sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))]; };
+	printf("replay %s: %zu frames, seed %u, %u thread(s) (ms/frame)\n", opt.replay.c_str(), frameMs.size(), header.seed, world.GetThreadCount());
+	printf("%10s %10s %10s %10s %8s %8s %8s\n", "mean", "p50", "p99", "max", "peakProj", "peakAst", "state");
+	printf("%10.4f %10.4f %10.4f %10.4f %8zu %8zu %08x\n", frameMs.empty() ? 0.0 : total / frameMs.size(),
+		pct(0.5), pct(0.99), sorted.empty() ? 0.0 : sorted.back(), peakProjectiles, peakAsteroids, world.Checksum());
+	return 0;
+}
+
+// Every row of the run plus what it ran with, one object per row
+static bool WriteJson(const char* path, const Options& opt) {
+	FILE* f = fopen(path, "w");
+	if (!f) return false;
+	fprintf(f, "{\"frames\":%d,\"dt\":%.6f,\"seed\":%u,\"kernel\":\"%s\",\"firstStepMs\":%.3f,\"results\":[\n",
+		opt.frames, opt.dt, opt.seed, Kernels::IntegrateName(), firstStepMs);
+	for (size_t i = 0; i < results.size(); i++) {
+		const Result& r = results[i];
+		fprintf(f, "%s{\"scenario\":\"%s\",\"phases\":{", i == 0 ? "" : ",", r.label.c_str());
+		for (int p = 0; p < static_cast<int>(World::Phase::COUNT); p++) {
+			fprintf(f, "%s\"%s\":%.6f", p == 0 ? "" : ",", World::PhaseName(static_cast<World::Phase>(p)), r.phaseMs[p]);
+		}
+		fprintf(f, "},\"frameMs\":%.6f,\"frameP99Ms\":%.6f,\"startMs\":%.6f,\"allocsPerFrame\":%.3f,\"bytesPerFrame\":%.1f,"
+			"\"peakRssMb\":%.1f,\"peakProjectiles\":%zu,\"peakAsteroids\":%zu,\"state\":\"%08x\"}\n",
+			r.frameMs, r.frameP99Ms, r.startMs, r.allocsPerFrame, r.bytesPerFrame, r.peakRssMb, r.peakProjectiles, r.peakAsteroids, r.checksum);
+	}
+	fprintf(f, "]}\n");
+	return fclose(f) == 0;
+}
+
+static bool ParseArgs(int argc, char** argv, Options& opt) {
+	for (int i = 1; i < argc; i++) {
+		const char* arg = argv[i];
+		if (strcmp(arg, "--invulnerable") == 0) {
+			opt.invulnerable = true;
+			continue;
+		}
+		if (strcmp(arg, "--sweep") == 0) {
+			opt.sweep = true;
+			continue;
+		}
+		if (strcmp(arg, "--kernels") == 0) {
+			opt.kernels = true;
+			continue;
+		}
+		if (strcmp(arg, "--snapshots") == 0) {
+			opt.snapshots = true;
+			continue;
+		}
+		if (strcmp(arg, "--audio") == 0) {
+			opt.audio = true;
+			continue;
+		}
+		if (strcmp(arg, "--scaling") == 0) {
+			opt.scaling = true;
+			continue;
+		}
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value) {
+			fprintf(stderr, "missing value for %s\n", arg);
+			return false;
+		}
+		if (strcmp(arg, "--scenario") == 0) opt.scenario = value;
+		else if (strcmp(arg, "--frames") == 0) opt.frames = atoi(value);
+		else if (strcmp(arg, "--dt") == 0) opt.dt = static_cast<float>(atof(value));
+		else if (strcmp(arg, "--seed") == 0) opt.seed = static_cast<unsigned>(strtoul(value, nullptr, 10));
+		else if (strcmp(arg, "--max-asteroids") == 0) opt.maxAsteroids = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--asteroids") == 0) opt.population = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--projectiles") == 0) opt.projectilePopulation = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--trace") == 0) opt.trace = value;
+		else if (strcmp(arg, "--replay") == 0) opt.replay = value;
+		else if (strcmp(arg, "--csv") == 0) opt.csv = value;
+		else if (strcmp(arg, "--json") == 0) opt.json = value;
+		else if (strcmp(arg, "--threads") == 0) opt.threads = static_cast<unsigned>(strtoul(value, nullptr, 10));
+		else if (strcmp(arg, "--tuning") == 0) {
+			int line = 0;
+			if (!opt.tuning.Load(value, &line)) {
+				fprintf(stderr, "cannot read tuning %s (line %d)\n", value, line);
+				return false;
+			}
+		}
+		else {
+			fprintf(stderr, "unknown option %s\n", arg);
+			return false;
+		}
+		i++;
+	}
+	return opt.frames > 0 && opt.dt > 0.f;
+}
+
+int main(int argc, char** argv) {
+	Options opt;
+	if (!ParseArgs(argc, argv, opt)) {
+		fprintf(stderr, "usage: Bench [--scenario name|all|stress] [--frames N] [--dt seconds] [--seed N] [--max-asteroids N]\n"
+		                "             [--asteroids N] [--projectiles N] [--invulnerable] [--sweep] [--kernels] [--snapshots] [--audio]\n"
+		                "             [--threads N] [--scaling] [--trace file.json] [--csv file.csv]\n"
+		                "             [--replay file.rep] [--json results.json] [--tuning file.txt]\n"
+		                "all runs the regular scenarios, stress the ones marked *\n");
+		for (const auto& sc : scenarios) {
+			fprintf(stderr, "  %-15s %s%s\n", sc.name, sc.description, sc.stress ? " *" : "");
+		}
+		return 1;
+	}
+
+	if (opt.kernels) {
+		RunKernels();
+		return 0;
+	}
+	if (opt.snapshots) {
+		RunSnapshots(opt);
+		return 0;
+	}
+	if (opt.audio) {
+		RunAudio(opt);
+		return 0;
+	}
+
+	if (!opt.replay.empty()) {
+		return RunReplay(opt);
+	}
+
+	printf("%d frames, dt %.4f s, seed %u (ms/frame)\n", opt.frames, opt.dt, opt.seed);
+	printf("%-18s", "scenario");
+	for (int p = 0; p < static_cast<int>(World::Phase::COUNT); p++) {
+		printf(" %12s", World::PhaseName(static_cast<World::Phase>(p)));
+	}
+	printf(" %12s %12s %9s %9s %8s %8s %8s %8s\n", "frame", "frameP99", "startMs", "allocs/f", "rssMB", "peakProj", "peakAst", "state");
+
+	const bool capture = !opt.trace.empty() || !opt.csv.empty();
+	if (capture) {
+#if PROFILER_ENABLED
+		Profiler::Instance().BeginCapture();
+#else
+		fprintf(stderr, "built with PROFILER_ENABLED=0, nothing to capture\n");
+#endif
+	}
+
+	bool found = false;
+	for (const auto& sc : scenarios) {
+		const bool group = sc.stress ? opt.scenario == "stress" : opt.scenario == "all";
+		if (group || opt.scenario == sc.name) {
+			if (opt.scaling) {
+				RunScaling(sc, opt);
+			}
+			else if (opt.sweep) {
+				// The ship sits in the middle of the swarm, keep it alive so it keeps firing
+				Options swept = opt;
+				swept.invulnerable = true;
+				for (size_t n : sweepPopulations) {
+					swept.population = n;
+					RunScenario(sc, swept);
+				}
+			}
+			else {
+				RunScenario(sc, opt);
+			}
+			found = true;
+		}
+	}
+	if (!found) {
+		fprintf(stderr, "unknown scenario %s\n", opt.scenario.c_str());
+		return 1;
+	}
+	if (firstStepMs >= 0.0) {
+		printf("startup: first step done %.2f ms after process start\n", firstStepMs);
+	}
+	if (!opt.json.empty() && !WriteJson(opt.json.c_str(), opt)) {
+		fprintf(stderr, "could not write %s\n", opt.json.c_str());
+		return 1;
+	}
+	if (capture && Profiler::Instance().IsCapturing()) {
+		// Frames of consecutive scenarios end up back to back in one capture
+		if (!Profiler::Instance().EndCapture(opt.trace.empty() ? "trace.json" : opt.trace.c_str(), opt.csv.empty() ? nullptr : opt.csv.c_str())) {
+			fprintf(stderr, "could not write the capture\n");
+			return 1;
+		}
+	}
+	return 0;
+}
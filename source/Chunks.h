@@ -0,0 +1,191 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+
+#include <raymath.h>
+
+#include "Snapshot.h"
+
+// --- WORLD CHUNKS ---
+// A world larger than the screen, cut into square chunks. The chunks around
+// the view are active: whatever is in them lives in the archetypes and is
+// simulated in full every step. Every other chunk keeps its items asleep in a
+// plain list. The owner wakes a chunk's sleepers when it becomes active and
+// catches up a few sleeping chunks per step with TickSome, so the cost of a
+// step follows the active area rather than the whole population.
+// What an item is and how it catches up is left to the owner.
+// Positions outside the world are clamped into the border chunks.
+
+// Axis-aligned box in world coordinates
+struct Box {
+	Vector2 min, max;
+};
+
+template <typename T>
+class ChunkMap {
+public:
+	void Init(float width, float height, float chunk) {
+		size = { width, height };
+		chunkSize = chunk;
+		invChunk = 1.f / chunk;
+		cols = std::max(1, static_cast<int>(ceilf(width * invChunk)));
+		rows = std::max(1, static_cast<int>(ceilf(height * invChunk)));
+		chunks.assign(static_cast<size_t>(cols) * rows, {});
+		active = {};
+		cursor = 0;
+		count = 0;
+	}
+
+	// Drops every sleeper, the active range stays
+	void Clear() {
+		for (Chunk& c : chunks) {
+			c.items.clear();
+		}
+		count = 0;
+	}
+
+	// Makes the chunks overlapping box the active ones, then calls
+	// onWake(chunk) for each of them that was not active before
+	template <typename Fn>
+	void SetActive(Box box, Fn&& onWake) {
+		const Range old = active;
+		active = { ChunkX(box.min.x), ChunkY(box.min.y), ChunkX(box.max.x), ChunkY(box.max.y) };
+		if (active == old) return;
+		for (int y = active.y0; y <= active.y1; y++) {
+			for (int x = active.x0; x <= active.x1; x++) {
+				if (!old.Contains(x, y)) onWake(Index(x, y));
+			}
+		}
+	}
+
+	bool IsActive(uint32_t chunk) const {
+		return active.Contains(static_cast<int>(chunk % cols), static_cast<int>(chunk / cols));
+	}
+
+	// Nothing can fall asleep while this holds, e.g. a world no larger than the view
+	bool AllActive() const {
+		return active.x0 == 0 && active.y0 == 0 && active.x1 == cols - 1 && active.y1 == rows - 1;
+	}
+
+	// Area of the active chunks, cut to the world
+	Box ActiveBox() const {
+		return {
+			{ active.x0 * chunkSize, active.y0 * chunkSize },
+			{ std::min(size.x, (active.x1 + 1) * chunkSize), std::min(size.y, (active.y1 + 1) * chunkSize) }
+		};
+	}
+
+	uint32_t ChunkAt(Vector2 p) const {
+		return Index(ChunkX(p.x), ChunkY(p.y));
+	}
+
+	void Put(uint32_t chunk, const T& item) {
+		chunks[chunk].items.push_back(item);
+		count++;
+	}
+
+	// Empties a chunk and hands every item to fn, which may Put it back into
+	// any chunk, this one included. Not reentrant.
+	template <typename Fn>
+	void Drain(uint32_t chunk, Fn&& fn) {
+		std::vector<T>& items = chunks[chunk].items;
+		if (items.empty()) return;
+		draining.swap(items);
+		count -= draining.size();
+		for (T& item : draining) {
+			fn(item);
+		}
+		draining.clear();
+	}
+
+	// Drains up to budget sleeping chunks that hold anything, taking turns
+	// over the whole map from where the last call stopped
+	template <typename Fn>
+	void TickSome(size_t budget, Fn&& fn) {
+		for (size_t visited = 0; budget > 0 && visited < chunks.size(); visited++) {
+			const uint32_t c = cursor;
+			cursor = (cursor + 1) % static_cast<uint32_t>(chunks.size());
+			if (IsActive(c) || chunks[c].items.empty()) continue;
+			Drain(c, fn);
+			budget--;
+		}
+	}
+
+	// Every sleeper, chunk by chunk in index order
+	template <typename Fn>
+	void ForEachSleeper(Fn&& fn) const {
+		for (const Chunk& c : chunks) {
+			for (const T& item : c.items) {
+				fn(item);
+			}
+		}
+	}
+
+	// Items asleep in all chunks together
+	size_t Sleeping() const {
+		return count;
+	}
+
+	size_t ChunkCount() const {
+		return chunks.size();
+	}
+
+	// Active range, round-robin position and every chunk's sleepers
+	void Save(SnapshotWriter& out) const {
+		out.Pod(active);
+		out.Pod(cursor);
+		for (const Chunk& c : chunks) {
+			out.Array(c.items);
+		}
+	}
+
+	bool Load(SnapshotReader& in) {
+		in.Pod(active);
+		in.Pod(cursor);
+		count = 0;
+		for (Chunk& c : chunks) {
+			in.Array(c.items);
+			count += c.items.size();
+		}
+		return in.Ok();
+	}
+
+private:
+	// Inclusive chunk coordinates; the default one is empty
+	struct Range {
+		int x0 = 0, y0 = 0, x1 = -1, y1 = -1;
+
+		bool Contains(int x, int y) const {
+			return x >= x0 && x <= x1 && y >= y0 && y <= y1;
+		}
+		bool operator==(const Range&) const = default;
+	};
+
+	struct Chunk {
+		std::vector<T> items;
+	};
+
+	int ChunkX(float x) const {
+		return std::clamp(static_cast<int>(floorf(x * invChunk)), 0, cols - 1);
+	}
+	int ChunkY(float y) const {
+		return std::clamp(static_cast<int>(floorf(y * invChunk)), 0, rows - 1);
+	}
+	uint32_t Index(int x, int y) const {
+		return static_cast<uint32_t>(y * cols + x);
+	}
+
+	Vector2 size{};
+	float chunkSize = 1.f;
+	float invChunk = 1.f;
+	int cols = 1;
+	int rows = 1;
+	Range active;
+	std::vector<Chunk> chunks;
+	std::vector<T> draining;
+	uint32_t cursor = 0;
+	size_t count = 0;
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+
+// --- COMMAND BUFFER ---
+// Structural changes (spawn / kill) recorded while a phase iterates an
+// archetype and applied in one batch at the sync point, so the columns never
+// grow or shrink under a live row index. Kills are swap-and-pop, which does
+// not preserve row order. Both queues keep their capacity between frames.
+template <typename A>
+class CommandBuffer {
+public:
+	using Row = typename A::Row;
+
+	void Reserve(size_t spawnCount, size_t killCount) {
+		spawns.reserve(spawnCount);
+		kills.reserve(killCount);
+	}
+
+	void Spawn(const Row& row) {
+		spawns.push_back(row);
+	}
+
+	// Queuing the same row twice is allowed, it is removed once
+	void Kill(uint32_t row) {
+		kills.push_back(row);
+	}
+
+	bool Empty() const {
+		return spawns.empty() && kills.empty();
+	}
+
+	// Kills first (rows refer to the archetype as it was during the phase), then spawns
+	void Apply(A& arch) {
+		Apply(arch, [](auto, const Row&) {});
+	}
+
+	// onSpawn(entity, row) is called for every spawn, in the order they were queued
+	template <typename OnSpawn>
+	void Apply(A& arch, OnSpawn&& onSpawn) {
+		// Highest row first: everything past the current slot is already settled,
+		// so the row swapped in from the back is never one still pending removal
+		std::sort(kills.begin(), kills.end(), std::greater<uint32_t>());
+		kills.erase(std::unique(kills.begin(), kills.end()), kills.end());
+		for (uint32_t row : kills) {
+			arch.RemoveRow(row);
+		}
+		for (const Row& row : spawns) {
+			onSpawn(arch.Create(row), row);
+		}
+
+		spawns.clear();
+		kills.clear();
+	}
+
+private:
+	std::vector<Row> spawns;
+	std::vector<uint32_t> kills;
+};
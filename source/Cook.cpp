@@ -0,0 +1,243 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+// Same decoders the game gets through raylib, without linking raylib
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#define QOI_IMPLEMENTATION
+#define QOI_NO_STDIO
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+#endif
+#include "external/stb_image.h"
+#include "external/qoi.h"
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+#include "AssetPack.h"
+
+// --- ASSET COOKER ---
+// Converts sprites from PNG to QOI next to the originals (or into --out).
+// QOI is lossless and decodes several times faster than PNG's inflate, and
+// the ResourceCache picks name.qoi over name.png when both are there, so the
+// game needs no other change.
+// Usage: Cook [--out dir] [--reps N] file.png...
+//        Cook --pack assets.pak file...
+// Every row reports both sizes and the time to decode each from memory
+// (averaged over --reps runs), so the gain is measured rather than assumed.
+// --pack writes the files as they are into one AssetPack instead, each under
+// its name without the directory.
+
+struct Options {
+	std::string out;        // directory for the .qoi files, next to the source when empty
+	int reps = 5;           // decodes per format when timing
+	std::string pack;       // write the files into this pack instead of cooking them
+	std::vector<const char*> files;
+};
+
+static bool ReadFile(const char* path, std::vector<unsigned char>& bytes) {
+	FILE* f = fopen(path, "rb");
+	if (!f) return false;
+	fseek(f, 0, SEEK_END);
+	const long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	bytes.resize(size > 0 ? static_cast<size_t>(size) : 0);
+	const bool ok = size > 0 && fread(bytes.data(), 1, bytes.size(), f) == bytes.size();
+	fclose(f);
+	return ok;
+}
+
+static bool WriteFile(const std::string& path, const void* data, size_t size) {
+	FILE* f = fopen(path.c_str(), "wb");
+	if (!f) return false;
+	const bool ok = fwrite(data, 1, size, f) == size;
+	return fclose(f) == 0 && ok;
+}
+
+// name.png -> [out/]name.qoi
+static std::string CookedPath(const char* file, const std::string& out) {
+	std::string path = file;
+	const size_t dot = path.find_last_of('.');
+	const size_t slash = path.find_last_of("/\\");
+	if (dot != std::string::npos && (slash == std::string::npos || dot > slash)) path.resize(dot);
+	if (!out.empty()) {
+		path = out + "/" + (slash == std::string::npos ? path : path.substr(slash + 1));
+	}
+	return path + ".qoi";
+}
+
+// Mean ms of reps calls to decode, which returns the pixels to free
+template <typename Decode>
+static double TimeDecode(int reps, Decode&& decode) {
+	auto start = std::chrono::steady_clock::now();
+	for (int r = 0; r < reps; r++) {
+		void* pixels = decode();
+		free(pixels);
+	}
+	std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+	return ms.count() / reps;
+}
+
+// Prints the row; false when the file could not be read, decoded or written
+static bool Cook(const char* file, const Options& opt, size_t& pngTotal, size_t& qoiTotal) {
+	std::vector<unsigned char> png;
+	if (!ReadFile(file, png)) {
+		fprintf(stderr, "cannot read %s\n", file);
+		return false;
+	}
+	int w = 0, h = 0, channels = 0;
+	unsigned char* rgba = stbi_load_from_memory(png.data(), static_cast<int>(png.size()), &w, &h, &channels, 4);
+	if (!rgba) {
+		fprintf(stderr, "cannot decode %s: %s\n", file, stbi_failure_reason());
+		return false;
+	}
+	const qoi_desc desc = { static_cast<unsigned int>(w), static_cast<unsigned int>(h), 4, QOI_SRGB };
+	int qoiSize = 0;
+	void* qoi = qoi_encode(rgba, &desc, &qoiSize);
+	const std::string path = CookedPath(file, opt.out);
+	const bool written = qoi && WriteFile(path, qoi, static_cast<size_t>(qoiSize));
+	if (!written) {
+		fprintf(stderr, "cannot write %s\n", path.c_str());
+		free(qoi);
+		stbi_image_free(rgba);
+		return false;
+	}
+
+	// QOI is lossless; a mismatch would be an encoder bug, not a rounding difference
+	qoi_desc read;
+	void* check = qoi_decode(qoi, qoiSize, &read, 4);
+	const bool same = check && read.width == desc.width && read.height == desc.height &&
+		memcmp(check, rgba, static_cast<size_t>(w) * h * 4) == 0;
+	free(check);
+
+	const double pngMs = TimeDecode(opt.reps, [&] {
+		int x, y, n;
+		return static_cast<void*>(stbi_load_from_memory(png.data(), static_cast<int>(png.size()), &x, &y, &n, 4));
+	});
+	const double qoiMs = TimeDecode(opt.reps, [&] {
+		qoi_desc d;
+		return qoi_decode(qoi, qoiSize, &d, 4);
+	});
+	free(qoi);
+	stbi_image_free(rgba);
+
+	printf("%-24s %5dx%-5d %10.1f %10.1f %+7.0f%% %10.3f %10.3f %8.2fx %s\n", file, w, h, png.size() / 1024.0, qoiSize / 1024.0,
+		100.0 * (static_cast<double>(qoiSize) / png.size() - 1.0), pngMs, qoiMs, pngMs / qoiMs, same ? "ok" : "MISMATCH");
+	pngTotal += png.size();
+	qoiTotal += static_cast<size_t>(qoiSize);
+	return same;
+}
+
+// Index sorted by hash, names, then the blobs in the order given
+static bool WritePack(const Options& opt) {
+	struct Source {
+		std::string name;
+		std::vector<unsigned char> bytes;
+		PackEntry entry;
+	};
+	std::vector<Source> sources;
+	std::string names;
+	for (const char* file : opt.files) {
+		Source s;
+		s.name = file;
+		const size_t slash = s.name.find_last_of("/\\");
+		if (slash != std::string::npos) s.name.erase(0, slash + 1);
+		if (!ReadFile(file, s.bytes)) {
+			fprintf(stderr, "cannot read %s\n", file);
+			return false;
+		}
+		for (const Source& other : sources) {
+			if (other.name == s.name) {
+				fprintf(stderr, "%s is in the pack twice\n", s.name.c_str());
+				return false;
+			}
+		}
+		s.entry = { PackHash(s.name), 0, s.bytes.size(), static_cast<uint32_t>(names.size()), static_cast<uint32_t>(s.name.size()) };
+		names += s.name;
+		sources.push_back(std::move(s));
+	}
+	const PackHeader header = { { PACK_MAGIC[0], PACK_MAGIC[1], PACK_MAGIC[2], PACK_MAGIC[3] }, PACK_VERSION,
+		static_cast<uint32_t>(sources.size()), static_cast<uint32_t>(names.size()) };
+	auto align = [](size_t at) { return (at + PACK_ALIGN - 1) / PACK_ALIGN * PACK_ALIGN; };
+	size_t at = sizeof(header) + sources.size() * sizeof(PackEntry) + names.size();
+	for (Source& s : sources) {
+		s.entry.offset = align(at);
+		at = s.entry.offset + s.bytes.size();
+	}
+	std::vector<PackEntry> index;
+	for (const Source& s : sources) {
+		index.push_back(s.entry);
+	}
+	std::sort(index.begin(), index.end(), [](const PackEntry& a, const PackEntry& b) { return a.hash < b.hash; });
+
+	std::vector<unsigned char> out(at, 0);
+	memcpy(out.data(), &header, sizeof(header));
+	memcpy(out.data() + sizeof(header), index.data(), index.size() * sizeof(PackEntry));
+	memcpy(out.data() + sizeof(header) + index.size() * sizeof(PackEntry), names.data(), names.size());
+	printf("%-24s %10s %10s\n", "asset", "KB", "offset");
+	for (const Source& s : sources) {
+		if (!s.bytes.empty()) memcpy(out.data() + s.entry.offset, s.bytes.data(), s.bytes.size());
+		printf("%-24s %10.1f %10llu\n", s.name.c_str(), s.bytes.size() / 1024.0, static_cast<unsigned long long>(s.entry.offset));
+	}
+	if (!WriteFile(opt.pack, out.data(), out.size())) {
+		fprintf(stderr, "cannot write %s\n", opt.pack.c_str());
+		return false;
+	}
+	printf("%s: %zu assets, %.1f KB\n", opt.pack.c_str(), sources.size(), out.size() / 1024.0);
+	return true;
+}
+
+static bool ParseArgs(int argc, char** argv, Options& opt) {
+	for (int i = 1; i < argc; i++) {
+		const char* arg = argv[i];
+		if (strncmp(arg, "--", 2) != 0) {
+			opt.files.push_back(arg);
+			continue;
+		}
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value) {
+			fprintf(stderr, "missing value for %s\n", arg);
+			return false;
+		}
+		if (strcmp(arg, "--out") == 0) opt.out = value;
+		else if (strcmp(arg, "--reps") == 0) opt.reps = atoi(value);
+		else if (strcmp(arg, "--pack") == 0) opt.pack = value;
+		else {
+			fprintf(stderr, "unknown option %s\n", arg);
+			return false;
+		}
+		i++;
+	}
+	return !opt.files.empty() && opt.reps > 0;
+}
+
+int main(int argc, char** argv) {
+	Options opt;
+	if (!ParseArgs(argc, argv, opt)) {
+		fprintf(stderr, "usage: Cook [--out dir] [--reps N] file.png...\n"
+		                "       Cook --pack assets.pak file...\n");
+		return 1;
+	}
+	if (!opt.pack.empty()) {
+		return WritePack(opt) ? 0 : 1;
+	}
+	printf("%-24s %11s %10s %10s %8s %10s %10s %9s\n", "asset", "size", "png KB", "qoi KB", "delta", "png ms", "qoi ms", "speedup");
+	size_t pngTotal = 0, qoiTotal = 0;
+	int failed = 0;
+	for (const char* file : opt.files) {
+		if (!Cook(file, opt, pngTotal, qoiTotal)) failed++;
+	}
+	if (pngTotal > 0) {
+		printf("%-24s %11s %10.1f %10.1f %+7.0f%%\n", "total", "", pngTotal / 1024.0, qoiTotal / 1024.0,
+			100.0 * (static_cast<double>(qoiTotal) / pngTotal - 1.0));
+	}
+	return failed == 0 ? 0 : 1;
+}
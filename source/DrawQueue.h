@@ -0,0 +1,237 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include <raylib.h>
+#include <rlgl.h>
+
+// --- DRAW QUEUE ---
+// Immediate-mode draws are recorded instead of issued, sorted by a 64-bit key
+// and then replayed. rlgl starts a new draw call whenever the texture or the
+// primitive (lines / quads) changes, so sorting the commands of a layer by
+// texture turns a frame's alternating sprites and shapes into a few runs.
+//
+// Key, most significant first:
+//   layer 8 | shader 8 | texture 16 | primitive 8 | depth 24
+// The sort is stable: commands with equal keys keep their submission order,
+// which is the painter's order within a run.
+//
+// Replay goes through a render batch owned by the queue, so the number of
+// draw calls and flushes rlgl made for the queue can be read back.
+
+enum class DrawLayer : uint8_t { BACKGROUND, PROJECTILES, ASTEROIDS, PARTICLES, PLAYER };
+
+class DrawQueue {
+public:
+	struct Stats {
+		int commands = 0;
+		int drawCalls = 0;          // rlgl draws issued while replaying
+		int flushes = 0;            // times the render batch was uploaded and drawn
+		int unsortedChanges = 0;    // texture / primitive changes in submission order
+	};
+
+	// After InitWindow
+	void Init() {
+		batch = rlLoadRenderBatch(1, RL_DEFAULT_BATCH_BUFFER_ELEMENTS);
+	}
+
+	void Unload() {
+		if (batch.draws != nullptr) rlUnloadRenderBatch(batch);
+		batch = {};
+	}
+
+	// DrawTexturePro
+	void Sprite(DrawLayer layer, const Texture2D& texture, Rectangle source, Rectangle dest, Vector2 origin, float rotation, Color tint, uint32_t depth = 0) {
+		Command& c = Push(layer, texture.id, QUADS, depth);
+		c.kind = Kind::SPRITE;
+		c.texture = texture;
+		c.source = source;
+		c.dest = dest;
+		c.origin = origin;
+		c.rotation = rotation;
+		c.color = tint;
+	}
+
+	// DrawPolyLines
+	void PolyLines(DrawLayer layer, Vector2 center, int sides, float radius, float rotation, Color color, uint32_t depth = 0) {
+		Command& c = Push(layer, rlGetTextureIdDefault(), LINES, depth);
+		c.kind = Kind::POLY_LINES;
+		c.dest = { center.x, center.y, radius, 0 };
+		c.sides = sides;
+		c.rotation = rotation;
+		c.color = color;
+	}
+
+	// DrawCircleV
+	void Circle(DrawLayer layer, Vector2 center, float radius, Color color, uint32_t depth = 0) {
+		Command& c = Push(layer, rlGetTextureIdDefault(), QUADS, depth);
+		c.kind = Kind::CIRCLE;
+		c.dest = { center.x, center.y, radius, 0 };
+		c.color = color;
+	}
+
+	// DrawRectanglePro
+	void Rect(DrawLayer layer, Rectangle dest, Vector2 origin, float rotation, Color color, uint32_t depth = 0) {
+		Command& c = Push(layer, rlGetTextureIdDefault(), QUADS, depth);
+		c.kind = Kind::RECT;
+		c.dest = dest;
+		c.origin = origin;
+		c.rotation = rotation;
+		c.color = color;
+	}
+
+	// DrawTriangle, counter-clockwise
+	void Triangle(DrawLayer layer, Vector2 a, Vector2 b, Vector2 c3, Color color, uint32_t depth = 0) {
+		Command& c = Push(layer, rlGetTextureIdDefault(), QUADS, depth);
+		c.kind = Kind::TRIANGLE;
+		c.dest = { a.x, a.y, b.x, b.y };
+		c.origin = c3;
+		c.color = color;
+	}
+
+	// Sorts and draws everything submitted since the last Flush
+	void Flush() {
+		const size_t n = commands.size();
+		if (n == 0) return;
+		Sort();
+		// rlgl has no render batches below OpenGL 3.3, replay straight into its default path
+		if (batch.draws == nullptr) {
+			for (size_t k = 0; k < n; k++) {
+				Replay(commands[order[k]]);
+			}
+			frame.commands += static_cast<int>(n);
+			commands.clear();
+			keys.clear();
+			return;
+		}
+
+		rlSetRenderBatchActive(&batch);
+		int lastCounter = batch.drawCounter;
+		float lastDepth = batch.currentDepth;
+		for (size_t k = 0; k < n; k++) {
+			Replay(commands[order[k]]);
+			// A flush inside rlgl resets the depth it hands out; count the draws it took along
+			if (batch.currentDepth < lastDepth) {
+				frame.flushes++;
+				frame.drawCalls += lastCounter;
+			}
+			lastCounter = batch.drawCounter;
+			lastDepth = batch.currentDepth;
+		}
+		if (batch.drawCounter > 1 || batch.draws[0].vertexCount > 0) {
+			frame.flushes++;
+			frame.drawCalls += batch.draws[batch.drawCounter - 1].vertexCount > 0 ? batch.drawCounter : batch.drawCounter - 1;
+		}
+		rlSetRenderBatchActive(nullptr);
+
+		frame.commands += static_cast<int>(n);
+		commands.clear();
+		keys.clear();
+	}
+
+	// Call once per frame before submitting; GetStats then reports the frame before
+	void BeginFrame() {
+		last = frame;
+		frame = {};
+		lastState = UINT64_MAX;
+	}
+
+	const Stats& GetStats() const {
+		return last;
+	}
+
+private:
+	enum class Kind : uint8_t { SPRITE, POLY_LINES, CIRCLE, RECT, TRIANGLE };
+	enum Primitive : uint8_t { QUADS, LINES };
+
+	struct Command {
+		Kind kind;
+		int sides;
+		Texture2D texture;
+		Rectangle source;
+		Rectangle dest;
+		Vector2 origin;
+		float rotation;
+		Color color;
+	};
+
+	static uint64_t Key(DrawLayer layer, uint8_t shader, unsigned int texture, Primitive primitive, uint32_t depth) {
+		return static_cast<uint64_t>(layer) << 56 | static_cast<uint64_t>(shader) << 48 |
+			static_cast<uint64_t>(texture & 0xffff) << 32 | static_cast<uint64_t>(primitive) << 24 | (depth & 0xffffff);
+	}
+
+	Command& Push(DrawLayer layer, unsigned int texture, Primitive primitive, uint32_t depth) {
+		const uint64_t key = Key(layer, 0, texture, primitive, depth);
+		// What rlgl would have done with the commands as submitted
+		const uint64_t state = key & STATE_MASK;
+		if (state != lastState) frame.unsortedChanges++;
+		lastState = state;
+		keys.push_back(key);
+		commands.emplace_back();
+		return commands.back();
+	}
+
+	// LSD radix sort of (key, index) by 8-bit digits; digits that are the same
+	// for every key are skipped, which is most of them in a typical frame
+	void Sort() {
+		const size_t n = keys.size();
+		order.resize(n);
+		scratch.resize(n);
+		for (size_t i = 0; i < n; i++) {
+			order[i] = static_cast<uint32_t>(i);
+		}
+		uint32_t* src = order.data();
+		uint32_t* dst = scratch.data();
+		for (int shift = 0; shift < 64; shift += 8) {
+			size_t count[257] = {};
+			for (size_t i = 0; i < n; i++) {
+				count[((keys[i] >> shift) & 0xff) + 1]++;
+			}
+			if (count[((keys[0] >> shift) & 0xff) + 1] == n) continue;
+			for (int d = 0; d < 256; d++) {
+				count[d + 1] += count[d];
+			}
+			for (size_t i = 0; i < n; i++) {
+				const uint32_t index = src[i];
+				dst[count[(keys[index] >> shift) & 0xff]++] = index;
+			}
+			std::swap(src, dst);
+		}
+		if (src != order.data()) {
+			memcpy(order.data(), src, n * sizeof(uint32_t));
+		}
+	}
+
+	static void Replay(const Command& c) {
+		switch (c.kind) {
+		case Kind::SPRITE:
+			DrawTexturePro(c.texture, c.source, c.dest, c.origin, c.rotation, c.color);
+			break;
+		case Kind::POLY_LINES:
+			DrawPolyLines({ c.dest.x, c.dest.y }, c.sides, c.dest.width, c.rotation, c.color);
+			break;
+		case Kind::CIRCLE:
+			DrawCircleV({ c.dest.x, c.dest.y }, c.dest.width, c.color);
+			break;
+		case Kind::RECT:
+			DrawRectanglePro(c.dest, c.origin, c.rotation, c.color);
+			break;
+		case Kind::TRIANGLE:
+			DrawTriangle({ c.dest.x, c.dest.y }, { c.dest.width, c.dest.height }, c.origin, c.color);
+			break;
+		}
+	}
+
+	// Bits of the key rlgl cares about: texture and primitive
+	static constexpr uint64_t STATE_MASK = 0x0000ffffff000000ull;
+
+	std::vector<Command> commands;
+	std::vector<uint64_t> keys;
+	std::vector<uint32_t> order, scratch;
+	rlRenderBatch batch{};
+	Stats frame, last;
+	uint64_t lastState = UINT64_MAX;
+};
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <vector>
+#include <tuple>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "Snapshot.h"
+
+// --- ENTITY COMPONENT STORAGE ---
+// An archetype holds every entity that has exactly the component set Cs...
+// as one dense column per component (structure of arrays): row i of every
+// column belongs to the same entity, so systems walk plain arrays.
+// Removing a row moves the last row into the hole. Rows are therefore not
+// stable across removals, Entity handles are (index + generation).
+
+struct Entity {
+	uint32_t index = UINT32_MAX;
+	uint32_t generation = 0;
+
+	bool operator==(const Entity&) const = default;
+};
+
+template <typename... Cs>
+class Archetype {
+public:
+	using Row = std::tuple<Cs...>;
+
+	template <typename C>
+	static constexpr bool Has = (std::is_same_v<C, Cs> || ...);
+
+	void Reserve(size_t n) {
+		(std::get<std::vector<Cs>>(columns).reserve(n), ...);
+		entities.reserve(n);
+	}
+
+	Entity Create(const Cs&... components) {
+		(std::get<std::vector<Cs>>(columns).push_back(components), ...);
+
+		Entity e;
+		if (!freeIndices.empty()) {
+			e.index = freeIndices.back();
+			freeIndices.pop_back();
+		}
+		else {
+			e.index = static_cast<uint32_t>(generations.size());
+			generations.push_back(0);
+			rowOf.push_back(NO_ROW);
+		}
+		e.generation = generations[e.index];
+		rowOf[e.index] = static_cast<uint32_t>(entities.size());
+		entities.push_back(e);
+		return e;
+	}
+
+	Entity Create(const Row& row) {
+		return std::apply([this](const Cs&... c) { return Create(c...); }, row);
+	}
+
+	// Swap-and-pop: the last row takes over this slot
+	void RemoveRow(uint32_t row) {
+		const uint32_t last = static_cast<uint32_t>(entities.size() - 1);
+		const Entity removed = entities[row];
+		if (row != last) {
+			((std::get<std::vector<Cs>>(columns)[row] = std::move(std::get<std::vector<Cs>>(columns)[last])), ...);
+			entities[row] = entities[last];
+			rowOf[entities[row].index] = row;
+		}
+		(std::get<std::vector<Cs>>(columns).pop_back(), ...);
+		entities.pop_back();
+		Release(removed);
+	}
+
+	void Remove(Entity e) {
+		if (IsAlive(e)) RemoveRow(rowOf[e.index]);
+	}
+
+	void Clear() {
+		for (const Entity& e : entities) {
+			Release(e);
+		}
+		(std::get<std::vector<Cs>>(columns).clear(), ...);
+		entities.clear();
+	}
+
+	bool IsAlive(Entity e) const {
+		return e.index < generations.size() && generations[e.index] == e.generation && rowOf[e.index] != NO_ROW;
+	}
+
+	uint32_t RowOf(Entity e) const {
+		return rowOf[e.index];
+	}
+
+	Entity EntityAt(uint32_t row) const {
+		return entities[row];
+	}
+
+	size_t Size() const {
+		return entities.size();
+	}
+
+	template <typename C>
+	C* Column() {
+		return std::get<std::vector<C>>(columns).data();
+	}
+
+	template <typename C>
+	const C* Column() const {
+		return std::get<std::vector<C>>(columns).data();
+	}
+
+	template <typename C>
+	C& Get(uint32_t row) {
+		return std::get<std::vector<C>>(columns)[row];
+	}
+
+	template <typename C>
+	const C& Get(uint32_t row) const {
+		return std::get<std::vector<C>>(columns)[row];
+	}
+
+	// Columns and handle bookkeeping, so handles held elsewhere stay valid across a Load
+	void Save(SnapshotWriter& out) const {
+		(out.Array(std::get<std::vector<Cs>>(columns)), ...);
+		out.Array(entities);
+		out.Array(rowOf);
+		out.Array(generations);
+		out.Array(freeIndices);
+	}
+
+	bool Load(SnapshotReader& in) {
+		(in.Array(std::get<std::vector<Cs>>(columns)), ...);
+		in.Array(entities);
+		in.Array(rowOf);
+		in.Array(generations);
+		in.Array(freeIndices);
+		return in.Ok();
+	}
+
+private:
+	void Release(Entity e) {
+		generations[e.index]++;
+		rowOf[e.index] = NO_ROW;
+		freeIndices.push_back(e.index);
+	}
+
+	static constexpr uint32_t NO_ROW = UINT32_MAX;
+
+	std::tuple<std::vector<Cs>...> columns;
+	std::vector<Entity> entities;       // row -> handle
+	std::vector<uint32_t> rowOf;        // handle index -> row
+	std::vector<uint32_t> generations;  // handle index -> current generation
+	std::vector<uint32_t> freeIndices;
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <memory_resource>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// --- FRAME ARENA ---
+// Bump allocator for data that only lives until the end of a frame (or a
+// simulation step): allocation is a pointer bump, deallocation does nothing
+// and Reset gives everything back at once. It is a std::pmr::memory_resource,
+// so transient containers use it as std::pmr::vector<T> v(&arena).
+// When the block is full, allocations go to the upstream resource instead and
+// are freed on Reset; Overflows() counts them so the block can be sized up.
+// Nothing allocated from the arena may outlive the next Reset.
+class FrameArena : public std::pmr::memory_resource {
+public:
+	explicit FrameArena(size_t capacity = 0, std::pmr::memory_resource* up = std::pmr::new_delete_resource())
+		: upstream(up)
+	{
+		Reserve(capacity);
+	}
+
+	~FrameArena() override {
+		Reset();
+		if (block) upstream->deallocate(block, capacity, alignof(std::max_align_t));
+	}
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	// Replaces the block; only between frames
+	void Reserve(size_t bytes) {
+		Reset();
+		if (block) upstream->deallocate(block, capacity, alignof(std::max_align_t));
+		block = bytes ? static_cast<std::byte*>(upstream->allocate(bytes, alignof(std::max_align_t))) : nullptr;
+		capacity = bytes;
+	}
+
+	void Reset() {
+		while (overflow) {
+			Overflow* next = overflow->next;
+			upstream->deallocate(overflow, overflow->bytes, overflow->align);
+			overflow = next;
+		}
+		used = 0;
+	}
+
+	size_t Used() const {
+		return used;
+	}
+	size_t Capacity() const {
+		return capacity;
+	}
+	// Most bytes in use at once since construction
+	size_t Peak() const {
+		return peak;
+	}
+	// Allocations that did not fit since construction
+	size_t Overflows() const {
+		return overflows;
+	}
+
+private:
+	// Header in front of every overflow allocation, so Reset can find them
+	struct Overflow {
+		Overflow* next;
+		size_t bytes;
+		size_t align;
+	};
+
+	void* do_allocate(size_t bytes, size_t align) override {
+		const uintptr_t base = reinterpret_cast<uintptr_t>(block);
+		const size_t start = ((base + used + align - 1) & ~(static_cast<uintptr_t>(align) - 1)) - base;
+		if (block && start + bytes <= capacity) {
+			used = start + bytes;
+			peak = std::max(peak, used);
+			return block + start;
+		}
+		overflows++;
+		const size_t headerAlign = std::max(align, alignof(Overflow));
+		const size_t header = (sizeof(Overflow) + headerAlign - 1) / headerAlign * headerAlign;
+		std::byte* p = static_cast<std::byte*>(upstream->allocate(header + bytes, headerAlign));
+		Overflow* o = reinterpret_cast<Overflow*>(p);
+		o->next = overflow;
+		o->bytes = header + bytes;
+		o->align = headerAlign;
+		overflow = o;
+		return p + header;
+	}
+
+	void do_deallocate(void*, size_t, size_t) override {}
+
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+		return this == &other;
+	}
+
+	std::pmr::memory_resource* upstream;
+	std::byte* block = nullptr;
+	size_t capacity = 0;
+	size_t used = 0;
+	size_t peak = 0;
+	size_t overflows = 0;
+	Overflow* overflow = nullptr;
+};
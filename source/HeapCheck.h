@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+
+// --- HEAP CHECK ---
+// Replaces the global operator new / delete with versions that count every
+// allocation of the process, workers included, so allocations per frame show
+// up without an external profiler. Include in exactly one translation unit.
+// Only C++ allocations are seen: malloc from C libraries (raylib, GLFW, the
+// driver) goes around it.
+namespace HeapCheck {
+	inline std::atomic<uint64_t> allocCount{ 0 };
+	inline std::atomic<uint64_t> allocBytes{ 0 };
+
+	// Since process start
+	inline uint64_t Allocations() {
+		return allocCount.load(std::memory_order_relaxed);
+	}
+	inline uint64_t Bytes() {
+		return allocBytes.load(std::memory_order_relaxed);
+	}
+
+	// Once the first warmUp frames are over, a frame should not touch the heap:
+	// transient data goes through a FrameArena, everything else is reserved or
+	// reused. Call Frame() once per frame; it returns true (at most once every
+	// quiet frames) when frames since the last report allocated.
+	class SteadyState {
+	public:
+		explicit SteadyState(uint64_t warmUpFrames = 120, uint64_t quietFrames = 120)
+			: warmUp(warmUpFrames), quiet(quietFrames) {}
+
+		bool Frame() {
+			const uint64_t now = Allocations();
+			const uint64_t allocs = now - last;
+			last = now;
+			if (++frame <= warmUp) return false;
+			if (allocs > 0) {
+				pending += allocs;
+				pendingFrames++;
+			}
+			if (pendingFrames == 0 || frame < nextReport) return false;
+			reported = pending;
+			reportedFrames = pendingFrames;
+			pending = 0;
+			pendingFrames = 0;
+			nextReport = frame + quiet;
+			return true;
+		}
+
+		// What the last report covers
+		uint64_t Allocations() const {
+			return reported;
+		}
+		uint64_t Frames() const {
+			return reportedFrames;
+		}
+
+	private:
+		uint64_t warmUp, quiet;
+		uint64_t frame = 0, last = 0, nextReport = 0;
+		uint64_t pending = 0, pendingFrames = 0;
+		uint64_t reported = 0, reportedFrames = 0;
+	};
+
+	inline void* CountedAlloc(size_t size) {
+		allocCount.fetch_add(1, std::memory_order_relaxed);
+		allocBytes.fetch_add(size, std::memory_order_relaxed);
+		if (void* p = malloc(size ? size : 1)) return p;
+		throw std::bad_alloc();
+	}
+
+	inline void* CountedAlloc(size_t size, std::align_val_t align) {
+		allocCount.fetch_add(1, std::memory_order_relaxed);
+		allocBytes.fetch_add(size, std::memory_order_relaxed);
+		const size_t a = static_cast<size_t>(align);
+#if defined(_WIN32)
+		if (void* p = _aligned_malloc(size ? size : 1, a)) return p;
+#else
+		if (void* p = aligned_alloc(a, (std::max<size_t>(size, 1) + a - 1) / a * a)) return p;
+#endif
+		throw std::bad_alloc();
+	}
+
+	inline void AlignedFree(void* p) {
+#if defined(_WIN32)
+		_aligned_free(p);
+#else
+		free(p);
+#endif
+	}
+}
+
+void* operator new(size_t size) { return HeapCheck::CountedAlloc(size); }
+void* operator new[](size_t size) { return HeapCheck::CountedAlloc(size); }
+void* operator new(size_t size, std::align_val_t align) { return HeapCheck::CountedAlloc(size, align); }
+void* operator new[](size_t size, std::align_val_t align) { return HeapCheck::CountedAlloc(size, align); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { HeapCheck::AlignedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { HeapCheck::AlignedFree(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { HeapCheck::AlignedFree(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { HeapCheck::AlignedFree(p); }
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+
+#include <raylib.h>
+#include <raymath.h>
+#include <rlgl.h>
+
+// --- INSTANCED RENDERER ---
+// One draw call per batch (mesh + texture) per frame, whatever the instance count.
+// Every batch owns a VAO with a static unit mesh and a dynamic per-instance buffer
+// that is re-uploaded once per frame; the vertex shader places each instance.
+// Needs OpenGL 3.3 (instanced arrays + layout qualifiers), check Supported() first.
+
+struct SpriteInstance {
+	Vector2 position{};
+	float rotation{};       // degrees, clockwise on screen like DrawTexturePro
+	Vector2 scale{};        // half extents in pixels
+	Color color = WHITE;
+	Rectangle source{};     // normalized texture rect (x, y, width, height)
+};
+
+class InstancedRenderer {
+public:
+	// Unit meshes in [-1, 1]; z is an inset in pixels so outlines keep a fixed line width
+	enum class Mesh { QUAD, TRIANGLE_OUTLINE, SQUARE_OUTLINE, PENTAGON_OUTLINE, DISC, ARROW, COUNT };
+
+	static bool Supported() {
+		return rlGetVersion() == RL_OPENGL_33 || rlGetVersion() == RL_OPENGL_43;
+	}
+
+	void Init() {
+		shader = rlLoadShaderCode(VS, FS);
+		mvpLoc = rlGetLocationUniform(shader, "mvp");
+		textureLoc = rlGetLocationUniform(shader, "texture0");
+	}
+
+	void Unload() {
+		for (Batch& b : batches) {
+			rlUnloadVertexArray(b.vao);
+			rlUnloadVertexBuffer(b.meshVbo);
+			if (b.instanceVbo != 0) rlUnloadVertexBuffer(b.instanceVbo);
+		}
+		batches.clear();
+		rlUnloadShaderProgram(shader);
+	}
+
+	// Batches are drawn in the order they were added. Texture 0 means untextured.
+	int AddBatch(Mesh mesh, unsigned int textureId) {
+		Batch b;
+		b.textureId = textureId != 0 ? textureId : rlGetTextureIdDefault();
+		BuildMesh(mesh, b.vertices);
+		b.vao = rlLoadVertexArray();
+		rlEnableVertexArray(b.vao);
+		b.meshVbo = rlLoadVertexBuffer(b.vertices.data(), static_cast<int>(b.vertices.size() * sizeof(float)), false);
+		rlSetVertexAttribute(0, 3, RL_FLOAT, false, 3 * sizeof(float), nullptr);
+		rlEnableVertexAttribute(0);
+		rlDisableVertexArray();
+		batches.push_back(std::move(b));
+		return static_cast<int>(batches.size() - 1);
+	}
+
+	void Submit(int batch, const SpriteInstance& instance) {
+		batches[batch].instances.push_back(instance);
+	}
+
+	// Flushes rlgl's own batch first so immediate-mode draws before this stay underneath
+	void Flush() {
+		rlDrawRenderBatchActive();
+		drawCalls = 0;
+		instanceCount = 0;
+
+		const Matrix mvp = MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection());
+		rlDisableBackfaceCulling();
+		rlEnableShader(shader);
+		rlSetUniformMatrix(mvpLoc, mvp);
+		const int slot = 0;
+		rlSetUniform(textureLoc, &slot, RL_SHADER_UNIFORM_INT, 1);
+
+		for (Batch& b : batches) {
+			if (b.instances.empty()) continue;
+			Upload(b);
+			rlActiveTextureSlot(0);
+			rlEnableTexture(b.textureId);
+			rlEnableVertexArray(b.vao);
+			rlDrawVertexArrayInstanced(0, static_cast<int>(b.vertices.size() / 3), static_cast<int>(b.instances.size()));
+			drawCalls++;
+			instanceCount += static_cast<int>(b.instances.size());
+			b.instances.clear();
+		}
+
+		rlDisableVertexArray();
+		rlDisableTexture();
+		rlDisableShader();
+		rlEnableBackfaceCulling();
+	}
+
+	int GetDrawCalls() const {
+		return drawCalls;
+	}
+	int GetInstanceCount() const {
+		return instanceCount;
+	}
+
+private:
+	struct Batch {
+		unsigned int textureId = 0;
+		unsigned int vao = 0;
+		unsigned int meshVbo = 0;
+		unsigned int instanceVbo = 0;
+		size_t capacity = 0;    // instances the instance VBO can hold
+		std::vector<float> vertices;
+		std::vector<SpriteInstance> instances;
+	};
+
+	// Grows the instance buffer geometrically, so uploads settle into plain updates
+	void Upload(Batch& b) {
+		const int bytes = static_cast<int>(b.instances.size() * sizeof(SpriteInstance));
+		if (b.instances.size() > b.capacity) {
+			if (b.instanceVbo != 0) rlUnloadVertexBuffer(b.instanceVbo);
+			b.capacity = std::max<size_t>(b.instances.size(), b.capacity * 2);
+			rlEnableVertexArray(b.vao);
+			b.instanceVbo = rlLoadVertexBuffer(nullptr, static_cast<int>(b.capacity * sizeof(SpriteInstance)), true);
+			const int stride = sizeof(SpriteInstance);
+			rlSetVertexAttribute(1, 3, RL_FLOAT, false, stride, (const void*)offsetof(SpriteInstance, position));
+			rlSetVertexAttribute(2, 2, RL_FLOAT, false, stride, (const void*)offsetof(SpriteInstance, scale));
+			rlSetVertexAttribute(3, 4, RL_UNSIGNED_BYTE, true, stride, (const void*)offsetof(SpriteInstance, color));
+			rlSetVertexAttribute(4, 4, RL_FLOAT, false, stride, (const void*)offsetof(SpriteInstance, source));
+			for (unsigned int a = 1; a <= 4; a++) {
+				rlEnableVertexAttribute(a);
+				rlSetVertexAttributeDivisor(a, 1);
+			}
+			rlDisableVertexArray();
+		}
+		rlUpdateVertexBuffer(b.instanceVbo, b.instances.data(), bytes, 0);
+	}
+
+	static void Push(std::vector<float>& v, float x, float y, float inset) {
+		v.push_back(x);
+		v.push_back(y);
+		v.push_back(inset);
+	}
+
+	static void BuildMesh(Mesh mesh, std::vector<float>& v) {
+		switch (mesh) {
+		case Mesh::QUAD:
+			Push(v, -1, -1, 0); Push(v, 1, -1, 0); Push(v, 1, 1, 0);
+			Push(v, -1, -1, 0); Push(v, 1, 1, 0); Push(v, -1, 1, 0);
+			break;
+		case Mesh::TRIANGLE_OUTLINE:
+		case Mesh::SQUARE_OUTLINE:
+		case Mesh::PENTAGON_OUTLINE: {
+			// Same vertex placement as DrawPolyLines: first corner at the rotation angle
+			const int sides = mesh == Mesh::TRIANGLE_OUTLINE ? 3 : mesh == Mesh::SQUARE_OUTLINE ? 4 : 5;
+			for (int i = 0; i < sides; i++) {
+				const float a0 = 2 * PI * i / sides, a1 = 2 * PI * (i + 1) / sides;
+				const float x0 = cosf(a0), y0 = sinf(a0), x1 = cosf(a1), y1 = sinf(a1);
+				Push(v, x0, y0, 0); Push(v, x1, y1, 0); Push(v, x1, y1, LINE_WIDTH);
+				Push(v, x0, y0, 0); Push(v, x1, y1, LINE_WIDTH); Push(v, x0, y0, LINE_WIDTH);
+			}
+			break;
+		}
+		case Mesh::DISC:
+			for (int i = 0; i < DISC_SEGMENTS; i++) {
+				const float a0 = 2 * PI * i / DISC_SEGMENTS, a1 = 2 * PI * (i + 1) / DISC_SEGMENTS;
+				Push(v, 0, 0, 0); Push(v, cosf(a0), sinf(a0), 0); Push(v, cosf(a1), sinf(a1), 0);
+			}
+			break;
+		case Mesh::ARROW:
+			// Pivot at the middle of the base, tip pointing up like the missile triangle
+			Push(v, 0, -1, 0); Push(v, -1, 0, 0); Push(v, 1, 0, 0);
+			break;
+		default:
+			break;
+		}
+	}
+
+	static constexpr float LINE_WIDTH = 1.5f;
+	static constexpr int DISC_SEGMENTS = 16;
+
+	static constexpr const char* VS = R"(#version 330
+layout(location = 0) in vec3 vertexPosition;
+layout(location = 1) in vec3 instanceTransform;
+layout(location = 2) in vec2 instanceScale;
+layout(location = 3) in vec4 instanceColor;
+layout(location = 4) in vec4 instanceSource;
+uniform mat4 mvp;
+out vec2 fragTexCoord;
+out vec4 fragColor;
+void main()
+{
+    vec2 local = vertexPosition.xy * instanceScale;
+    float len = length(vertexPosition.xy);
+    if (len > 0.0) local -= vertexPosition.xy / len * vertexPosition.z;
+    float r = radians(instanceTransform.z);
+    float c = cos(r);
+    float s = sin(r);
+    vec2 world = instanceTransform.xy + vec2(local.x * c - local.y * s, local.x * s + local.y * c);
+    fragTexCoord = instanceSource.xy + (vertexPosition.xy * 0.5 + 0.5) * instanceSource.zw;
+    fragColor = instanceColor;
+    gl_Position = mvp * vec4(world, 0.0, 1.0);
+}
+)";
+
+	static constexpr const char* FS = R"(#version 330
+in vec2 fragTexCoord;
+in vec4 fragColor;
+uniform sampler2D texture0;
+out vec4 finalColor;
+void main()
+{
+    finalColor = texture(texture0, fragTexCoord) * fragColor;
+}
+)";
+
+	unsigned int shader = 0;
+	int mvpLoc = -1;
+	int textureLoc = -1;
+	std::vector<Batch> batches;
+	int drawCalls = 0;
+	int instanceCount = 0;
+};
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <type_traits>
+#include <cstddef>
+
+#include "Profiler.h"
+
+// --- JOB SYSTEM ---
+// Fixed pool of worker threads, each with its own job deque. The owner pops
+// the newest job from the back, idle threads steal the oldest from the front
+// of someone else's deque. The thread calling ParallelFor is worker 0 and
+// runs jobs too until its loop is done, so a pool of 1 runs everything inline.
+// Jobs only split index ranges: anything order-dependent is left to the
+// caller, which keeps results independent of the thread count.
+// ParallelFor is meant to be called from one thread (the owner) at a time.
+class JobSystem {
+public:
+	// threadCount includes the calling thread; 0 means one per hardware thread
+	explicit JobSystem(unsigned threadCount = 1) {
+		if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+		queues.resize(threadCount);
+		for (auto& q : queues) {
+			q = std::make_unique<Queue>();
+		}
+		for (unsigned i = 1; i < threadCount; i++) {
+			workers.emplace_back([this, i] { WorkerLoop(i); });
+		}
+	}
+
+	~JobSystem() {
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			stop = true;
+		}
+		wake.notify_all();
+		for (std::thread& t : workers) {
+			t.join();
+		}
+	}
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	unsigned ThreadCount() const {
+		return static_cast<unsigned>(queues.size());
+	}
+
+	// Calls fn(begin, end) over [0, n) in chunks of at most grain indices (the
+	// last one may be shorter) and returns once every chunk has run.
+	// Chunk boundaries are always multiples of grain.
+	template <typename Fn>
+	void ParallelFor(size_t n, size_t grain, Fn&& fn) {
+		if (n == 0) return;
+		grain = std::max<size_t>(grain, 1);
+		const size_t chunks = (n + grain - 1) / grain;
+		if (chunks == 1 || queues.size() == 1) {
+			for (size_t begin = 0; begin < n; begin += grain) {
+				fn(begin, std::min(n, begin + grain));
+			}
+			return;
+		}
+
+		std::atomic<size_t> pending{ chunks };
+		Job job;
+		job.run = [](void* ctx, size_t begin, size_t end) { (*static_cast<std::remove_reference_t<Fn>*>(ctx))(begin, end); };
+		job.ctx = &fn;
+		job.pending = &pending;
+		// Contiguous runs of chunks per deque, so an unstolen worker walks memory in order
+		const size_t perQueue = (chunks + queues.size() - 1) / queues.size();
+		for (size_t q = 0; q < queues.size(); q++) {
+			const size_t first = q * perQueue, last = std::min(chunks, first + perQueue);
+			if (first >= last) break;
+			std::lock_guard<std::mutex> lock(queues[q]->mutex);
+			for (size_t c = last; c-- > first;) {
+				job.begin = c * grain;
+				job.end = std::min(n, job.begin + grain);
+				queues[q]->PushBack(job);
+			}
+		}
+		queued.fetch_add(chunks);
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+		}
+		wake.notify_all();
+
+		while (pending.load(std::memory_order_acquire) != 0) {
+			if (!RunOne(0)) std::this_thread::yield();
+		}
+	}
+
+private:
+	struct Job {
+		void (*run)(void* ctx, size_t begin, size_t end) = nullptr;
+		void* ctx = nullptr;
+		size_t begin = 0, end = 0;
+		std::atomic<size_t>* pending = nullptr;
+	};
+
+	// Ring buffer rather than std::deque, which allocates and frees blocks as
+	// jobs come and go; this one only grows, by doubling, to the largest batch
+	struct Queue {
+		std::mutex mutex;
+		std::vector<Job> ring;
+		size_t head = 0, count = 0;
+
+		bool Empty() const {
+			return count == 0;
+		}
+		void PushBack(const Job& job) {
+			if (count == ring.size()) {
+				std::vector<Job> grown(std::max<size_t>(ring.size() * 2, 64));
+				for (size_t i = 0; i < count; i++) {
+					grown[i] = ring[(head + i) & (ring.size() - 1)];
+				}
+				ring.swap(grown);
+				head = 0;
+			}
+			ring[(head + count++) & (ring.size() - 1)] = job;
+		}
+		Job PopBack() {
+			return ring[(head + --count) & (ring.size() - 1)];
+		}
+		Job PopFront() {
+			const Job job = ring[head];
+			head = (head + 1) & (ring.size() - 1);
+			count--;
+			return job;
+		}
+	};
+
+	// Own deque first (newest job), then steal (oldest job) from the others
+	bool RunOne(unsigned self) {
+		Job job;
+		bool found = false;
+		{
+			Queue& q = *queues[self];
+			std::lock_guard<std::mutex> lock(q.mutex);
+			if (!q.Empty()) {
+				job = q.PopBack();
+				found = true;
+			}
+		}
+		for (size_t k = 1; !found && k < queues.size(); k++) {
+			Queue& q = *queues[(self + k) % queues.size()];
+			std::lock_guard<std::mutex> lock(q.mutex);
+			if (!q.Empty()) {
+				job = q.PopFront();
+				found = true;
+			}
+		}
+		if (!found) return false;
+		queued.fetch_sub(1);
+		{
+			PROFILE_SCOPE("job");
+			job.run(job.ctx, job.begin, job.end);
+		}
+		job.pending->fetch_sub(1, std::memory_order_release);
+		return true;
+	}
+
+	void WorkerLoop(unsigned self) {
+		for (;;) {
+			if (RunOne(self)) continue;
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			wake.wait(lock, [this] { return stop || queued.load() > 0; });
+			if (stop) return;
+		}
+	}
+
+	std::vector<std::unique_ptr<Queue>> queues;
+	std::vector<std::thread> workers;
+	std::atomic<size_t> queued{ 0 };
+	std::mutex sleepMutex;
+	std::condition_variable wake;
+	bool stop = false;
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#else
+#define KERNELS_X86 0
+#endif
+
+// MSVC lets any function use AVX2 intrinsics; GCC/Clang need the target attribute
+// so the rest of the program can still be built for baseline x86-64
+#if KERNELS_X86 && !(defined(_MSC_VER) && !defined(__clang__))
+#define KERNEL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define KERNEL_TARGET_AVX2
+#endif
+
+// --- BATCH KERNELS ---
+// Motion integration over the TransformA / Physics columns, viewed as flat
+// float arrays: entity i is {x, y, rotation} at [3i, 3i+3) in both, so
+// transform += physics * dt is one contiguous multiply-add over 3n floats.
+// The same pass writes an out-of-bounds bitmask (bit i%8 of byte i/8) for
+// positions outside [min - pad, max + pad], pad being radius[i] or 0 when
+// radius is null. Both paths use a separate multiply and add (no FMA) so the
+// dispatch choice does not change results on builds that keep float contraction off.
+namespace Kernels {
+	using IntegrateFn = void (*)(float* transform, const float* physics, const float* radius, size_t n,
+		float dt, float minX, float minY, float maxX, float maxY, uint8_t* outOfBounds);
+
+	inline void IntegrateScalar(float* transform, const float* physics, const float* radius, size_t n,
+		float dt, float minX, float minY, float maxX, float maxY, uint8_t* outOfBounds) {
+		for (size_t i = 0; i < (n + 7) / 8; i++) {
+			outOfBounds[i] = 0;
+		}
+		for (size_t i = 0; i < n; i++) {
+			float* t = transform + 3 * i;
+			const float* p = physics + 3 * i;
+			t[0] = t[0] + p[0] * dt;
+			t[1] = t[1] + p[1] * dt;
+			t[2] = t[2] + p[2] * dt;
+			const float pad = radius ? radius[i] : 0.f;
+			if (t[0] < minX - pad || t[0] > maxX + pad || t[1] < minY - pad || t[1] > maxY + pad) {
+				outOfBounds[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+			}
+		}
+	}
+
+#if KERNELS_X86
+	KERNEL_TARGET_AVX2
+	inline void IntegrateAVX2(float* transform, const float* physics, const float* radius, size_t n,
+		float dt, float minX, float minY, float maxX, float maxY, uint8_t* outOfBounds) {
+		const __m256 vdt = _mm256_set1_ps(dt);
+		const __m256 vx0 = _mm256_set1_ps(minX);
+		const __m256 vy0 = _mm256_set1_ps(minY);
+		const __m256 vx1 = _mm256_set1_ps(maxX);
+		const __m256 vy1 = _mm256_set1_ps(maxY);
+		const __m256 zero = _mm256_setzero_ps();
+		// Lane order after the blends below, see the comment in the loop
+		const __m256i xOrder = _mm256_setr_epi32(0, 3, 6, 1, 4, 7, 2, 5);
+		const __m256i yOrder = _mm256_setr_epi32(1, 4, 7, 2, 5, 0, 3, 6);
+
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			float* t = transform + 3 * i;
+			const float* p = physics + 3 * i;
+			const __m256 t0 = _mm256_add_ps(_mm256_loadu_ps(t), _mm256_mul_ps(_mm256_loadu_ps(p), vdt));
+			const __m256 t1 = _mm256_add_ps(_mm256_loadu_ps(t + 8), _mm256_mul_ps(_mm256_loadu_ps(p + 8), vdt));
+			const __m256 t2 = _mm256_add_ps(_mm256_loadu_ps(t + 16), _mm256_mul_ps(_mm256_loadu_ps(p + 16), vdt));
+			_mm256_storeu_ps(t, t0);
+			_mm256_storeu_ps(t + 8, t1);
+			_mm256_storeu_ps(t + 16, t2);
+
+			// Deinterleave the stride-3 x and y: x sits in lanes 0,3,6 of t0, 1,4,7 of t1
+			// and 2,5 of t2; blending those together and permuting puts entity k in lane k
+			const __m256 x = _mm256_permutevar8x32_ps(_mm256_blend_ps(_mm256_blend_ps(t0, t1, 0x92), t2, 0x24), xOrder);
+			const __m256 y = _mm256_permutevar8x32_ps(_mm256_blend_ps(_mm256_blend_ps(t0, t1, 0x24), t2, 0x49), yOrder);
+
+			const __m256 pad = radius ? _mm256_loadu_ps(radius + i) : zero;
+			__m256 out = _mm256_cmp_ps(x, _mm256_sub_ps(vx0, pad), _CMP_LT_OQ);
+			out = _mm256_or_ps(out, _mm256_cmp_ps(x, _mm256_add_ps(vx1, pad), _CMP_GT_OQ));
+			out = _mm256_or_ps(out, _mm256_cmp_ps(y, _mm256_sub_ps(vy0, pad), _CMP_LT_OQ));
+			out = _mm256_or_ps(out, _mm256_cmp_ps(y, _mm256_add_ps(vy1, pad), _CMP_GT_OQ));
+			outOfBounds[i / 8] = static_cast<uint8_t>(_mm256_movemask_ps(out));
+		}
+		if (i < n) {
+			IntegrateScalar(transform + 3 * i, physics + 3 * i, radius ? radius + i : nullptr, n - i,
+				dt, minX, minY, maxX, maxY, outOfBounds + i / 8);
+		}
+	}
+#endif
+
+	inline bool CpuHasAVX2() {
+#if KERNELS_X86 && defined(_MSC_VER) && !defined(__clang__)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) return false;
+		__cpuid(info, 1);
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		const bool avx = (info[2] & (1 << 28)) != 0;
+		if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#elif KERNELS_X86
+		return __builtin_cpu_supports("avx2");
+#else
+		return false;
+#endif
+	}
+
+	// Picked once at startup
+	inline const bool hasAVX2 = CpuHasAVX2();
+#if KERNELS_X86
+	inline const IntegrateFn Integrate = hasAVX2 ? IntegrateAVX2 : IntegrateScalar;
+#else
+	inline const IntegrateFn Integrate = IntegrateScalar;
+#endif
+	inline const char* IntegrateName() {
+		return Integrate == IntegrateScalar ? "scalar" : "avx2";
+	}
+}
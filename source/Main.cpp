@@ -5,31 +5,33 @@
 #include <cstdlib>
 #include <cmath>
 #include <ctime>
+#include <cstring>
+#include <string>
 
 #include <raylib.h>
 #include <raymath.h>
 
-// --- UTILS ---
-namespace Utils {
-	inline static float RandomFloat(float min, float max) {
-		return min + static_cast<float>(rand()) / RAND_MAX * (max - min);
-	}
-}
-
-// --- TRANSFORM, PHYSICS, LIFETIME, RENDERABLE ---
-struct TransformA {
-	Vector2 position{};
-	float rotation{};
-};
-
-struct Physics {
-	Vector2 velocity{};
-	float rotationSpeed{};
-};
-
-struct Renderable {
-	enum Size { SMALL = 1, MEDIUM = 2, LARGE = 4 } size = SMALL;
-};
+#include "World.h"
+#include "InstancedRenderer.h"
+#include "Resources.h"
+#include "Audio.h"
+#include "Profiler.h"
+#include "Replay.h"
+#include "DrawQueue.h"
+#include "FrameArena.h"
+
+// Debug builds count heap allocations and warn about any in steady-state frames;
+// -DHEAP_CHECK=0 or 1 overrides
+#ifndef HEAP_CHECK
+#ifdef _DEBUG
+#define HEAP_CHECK 1
+#else
+#define HEAP_CHECK 0
+#endif
+#endif
+#if HEAP_CHECK
+#include "HeapCheck.h"
+#endif
 
 // --- RENDERER ---
 class Renderer {
@@ -39,9 +41,11 @@ public:
 		return inst;
 	}
 
+	// No frame cap: the simulation runs at its own fixed rate, so drawing
+	// follows the display's refresh (or runs flat out without vsync)
 	void Init(int w, int h, const char* title) {
+		SetConfigFlags(FLAG_VSYNC_HINT);
 		InitWindow(w, h, title);
-		SetTargetFPS(60);
 		screenW = w;
 		screenH = h;
 	}
@@ -55,10 +59,6 @@ public:
 		EndDrawing();
 	}
 
-	void DrawPoly(const Vector2& pos, int sides, float radius, float rot) {
-		DrawPolyLines(pos, sides, radius, rot, WHITE);
-	}
-
 	int Width() const {
 		return screenW;
 	}
@@ -74,543 +74,372 @@ private:
 	int screenH{};
 };
 
-// --- ASTEROID HIERARCHY ---
-
-class Asteroid {
-public:
-	Asteroid(int screenW, int screenH) {
-		init(screenW, screenH);
-	}
-	virtual ~Asteroid() = default;
-
-	bool Update(float dt) {
-		transform.position = Vector2Add(transform.position, Vector2Scale(physics.velocity, dt));
-		transform.rotation += physics.rotationSpeed * dt;
-		if (transform.position.x < -GetRadius() || transform.position.x > Renderer::Instance().Width() + GetRadius() ||
-			transform.position.y < -GetRadius() || transform.position.y > Renderer::Instance().Height() + GetRadius())
-			return false;
-		return true;
-	}
-	virtual void Draw() const = 0;
-
-	Vector2 GetPosition() const {
-		return transform.position;
-	}
-
-	virtual float GetRadius() const {
-		return 16.f * (float)render.size;
-	}
+// --- ENTITY DRAWING ---
+// Atlas sprites behind the simulation's TextureId
+struct Sprites {
+	ResourceCache* cache = nullptr;
+	SpriteHandle handles[static_cast<int>(TextureId::COUNT)] = {};
 
-	bool IsAlive() {
-		return alive;
+	void Load(ResourceCache& resources) {
+		cache = &resources;
+		handles[static_cast<int>(TextureId::GEEBLE)] = cache->Acquire("geeble.png");
+		handles[static_cast<int>(TextureId::SPARK_FLAME)] = cache->Acquire("spark_flame.png");
 	}
-	int GetDamage() const {
-		return baseDamage * static_cast<int>(render.size);
-	}
-	void TakeDamage(int dmg) {
-		if (!alive){
-				return;
-		}
-			hp -= dmg;
-		if (hp <= 0){
-				alive = 0;
+	void Unload() {
+		for (SpriteHandle& h : handles) {
+			cache->Release(h);
+			h = {};
 		}
-		
-		return;
 	}
-	int GetSize() const {
-		return static_cast<int>(render.size);
+	SpriteHandle Get(TextureId id) const {
+		return handles[static_cast<int>(id)];
 	}
+	bool Ready(TextureId id) const {
+		return cache->Ready(Get(id));
+	}
+};
 
-protected:
-	void init(int screenW, int screenH) {
-		// Choose size
-		render.size = static_cast<Renderable::Size>(1 << GetRandomValue(0, 2));
-
-		// Spawn at random edge
-		switch (GetRandomValue(0, 3)) {
-		case 0:
-			transform.position = { Utils::RandomFloat(0, screenW), -GetRadius() };
-			break;
-		case 1:
-			transform.position = { screenW + GetRadius(), Utils::RandomFloat(0, screenH) };
-			break;
-		case 2:
-			transform.position = { Utils::RandomFloat(0, screenW), screenH + GetRadius() };
-			break;
-		default:
-			transform.position = { -GetRadius(), Utils::RandomFloat(0, screenH) };
-			break;
-		}
-
-		// Aim towards center with jitter
-		float maxOff = fminf(screenW, screenH) * 0.1f;
-		float ang = Utils::RandomFloat(0, 2 * PI);
-		float rad = Utils::RandomFloat(0, maxOff);
-		Vector2 center = {
-										 screenW * 0.5f + cosf(ang) * rad,
-										 screenH * 0.5f + sinf(ang) * rad
-		};
+// Drawn in place of a sprite that is still loading
+static constexpr Color C_PLACEHOLDER = GRAY;
+static constexpr int C_PLACEHOLDER_SIDES = 5;
 
-		Vector2 dir = Vector2Normalize(Vector2Subtract(center, transform.position));
-		physics.velocity = Vector2Scale(dir, Utils::RandomFloat(SPEED_MIN, SPEED_MAX));
-		physics.rotationSpeed = Utils::RandomFloat(ROT_MIN, ROT_MAX);
+// The immediate-mode draw systems below record into a DrawQueue, which groups
+// them by texture and primitive before anything reaches rlgl. Every draw
+// system skips what lies outside the view (world coordinates) it is given.
 
-		transform.rotation = Utils::RandomFloat(0, 360);
-	}
+// Reaches past the position of the longest projectile (the laser) and the largest particle
+static constexpr float C_CULL_PAD = 32.f;
 
-	TransformA transform;
-	Physics    physics;
-	Renderable render;
-	bool alive = true;
-	float hp = 20 * (float)render.size;
-	int baseDamage = 0;
-	static constexpr float LIFE = 10.f;
-	static constexpr float SPEED_MIN = 125.f;
-	static constexpr float SPEED_MAX = 250.f;
-	static constexpr float ROT_MIN = 50.f;
-	static constexpr float ROT_MAX = 240.f;
-};
+// Whether something within reach of p can show up in the view
+static bool InView(const Box& view, Vector2 p, float reach) {
+	return p.x + reach >= view.min.x && p.x - reach <= view.max.x && p.y + reach >= view.min.y && p.y - reach <= view.max.y;
+}
 
-class TriangleAsteroid : public Asteroid {
-public:
-	TriangleAsteroid(int w, int h) : Asteroid(w, h) { baseDamage = 5; }
-	void Draw() const override {
-		Renderer::Instance().DrawPoly(transform.position, 3, GetRadius(), transform.rotation);
-	}
-};
-class SquareAsteroid : public Asteroid {
-public:
-	SquareAsteroid(int w, int h) : Asteroid(w, h) { baseDamage = 10; }
-	void Draw() const override {
-		Renderer::Instance().DrawPoly(transform.position, 4, GetRadius(), transform.rotation);
-	}
-};
-class PentagonAsteroid : public Asteroid {
-public:
-	PentagonAsteroid(int w, int h) : Asteroid(w, h) { baseDamage = 15; }
-	void Draw() const override {
-		Renderer::Instance().DrawPoly(transform.position, 5, GetRadius(), transform.rotation);
-	}
-};
-class GeebleAsteroid : public Asteroid {
-public:
-	GeebleAsteroid(int w, int h) : Asteroid(w, h) {
-		baseDamage = 15;
-		if (!GeebleLoaded) {
-		textureGeeble = LoadTexture("geeble.png");
-		GenTextureMipmaps(&textureGeeble);                                                        // Generate GPU mipmaps for a texture
-		SetTextureFilter(textureGeeble, 2);
-		GeebleLoaded = true;
-		}
-		scale = 0.2f;
-		hp = 20 * (float)render.size;
-	}
-	void Draw() const override {
-		Rectangle source = { 0, 0, static_cast<float>(textureGeeble.width), static_cast<float>(textureGeeble.height) };
+// Draw system for asteroids: outline polygons, or the kind's sprite sized to the collider
+// (a grey outline while the sprite loads)
+static void DrawAsteroids(const AsteroidArchetype& asteroids, const Sprites& sprites, const Box& view, float alpha, DrawQueue& queue) {
+	const TransformA* current = asteroids.Column<TransformA>();
+	const PrevTransform* prev = asteroids.Column<PrevTransform>();
+	const Collider* collider = asteroids.Column<Collider>();
+	const AsteroidData* data = asteroids.Column<AsteroidData>();
+	for (size_t i = 0; i < asteroids.Size(); i++) {
+		const AsteroidKind& kind = asteroidKinds[data[i].kind];
+		const TransformA transform = Interpolate(prev[i], current[i], alpha);
+		if (!InView(view, transform.position, collider[i].radius)) continue;
+		if (kind.texture == TextureId::NONE) {
+			queue.PolyLines(DrawLayer::ASTEROIDS, transform.position, kind.sides, collider[i].radius, transform.rotation, WHITE);
+			continue;
+		}
+		if (!sprites.Ready(kind.texture)) {
+			queue.PolyLines(DrawLayer::ASTEROIDS, transform.position, C_PLACEHOLDER_SIDES, collider[i].radius, transform.rotation, C_PLACEHOLDER);
+			continue;
+		}
+		const SpriteHandle sprite = sprites.Get(kind.texture);
+		const Rectangle size = sprites.cache->Source(sprite);
+		Rectangle source = { 0, 0, size.width, size.height };
 		Rectangle dest = { 
 			transform.position.x,
 			transform.position.y,
-			textureGeeble.width * scale * (float)render.size * 0.5f,
-			textureGeeble.height * scale * (float)render.size * 0.5f
+			collider[i].radius * 2.f,
+			collider[i].radius * 2.f * size.height / size.width
 
 		};
 		Vector2 origin = {
 		dest.width *0.5f,
 		dest.height *0.5f};
-		DrawTexturePro(textureGeeble, source, dest , origin ,transform.rotation ,WHITE);
-	}
-	float GetRadius() const override {
-		return (textureGeeble.width * scale * (float)render.size) * 0.25f;
-	}
-private:
-	static Texture2D textureGeeble;
-	static bool GeebleLoaded;
-	float scale;
-
-};
-Texture2D GeebleAsteroid::textureGeeble = { 0 };
-bool GeebleAsteroid::GeebleLoaded = false;
-
-// Shape selector
-enum class AsteroidShape { TRIANGLE = 3, SQUARE = 4, PENTAGON = 5,GEEBLE=6, RANDOM = 0 };
-// Ship selector
-enum class Character {PIBBLE, WASHINGTON,GMAIL, COUNT};
-// Factory
-static inline std::unique_ptr<Asteroid> MakeAsteroid(int w, int h, AsteroidShape shape) {
-	switch (shape) {
-	case AsteroidShape::TRIANGLE:
-		return std::make_unique<TriangleAsteroid>(w, h);
-	case AsteroidShape::SQUARE:
-		return std::make_unique<SquareAsteroid>(w, h);
-	case AsteroidShape::PENTAGON:
-		return std::make_unique<PentagonAsteroid>(w, h);
-	case AsteroidShape::GEEBLE:
-		return std::make_unique<GeebleAsteroid>(w, h);
-	default: {
-		return MakeAsteroid(w, h, static_cast<AsteroidShape>(3 + GetRandomValue(0, 2)));
-	}
+		queue.Sprite(DrawLayer::ASTEROIDS, sprites.cache->Atlas(), sprites.cache->AtlasSource(sprite, source), dest, origin, transform.rotation, WHITE);
 	}
 }
 
-// --- PROJECTILE HIERARCHY ---
-enum class WeaponType { LASER, BULLET, MISSILE,GRENADES,SHRAPNEL,EXMISSILE, EXPLOSION, COUNT};
+// How each weapon's projectiles look; missile blasts and explosions only show
+// through their particles
+enum class ProjectileLook : uint8_t { NONE, DISC, LASER, MISSILE };
 
-class Projectile {
-public:
-	Projectile(Vector2 pos, Vector2 vel, int dmg, WeaponType wt)
-	{
-		transform.position = pos;
-		physics.velocity = vel;
-		baseDamage = dmg;
-		type = wt;
-		explodeRadius = 50.0f;
-		time = 0.0f;
-		if (!TextureLoaded) {
-			textureMissile = LoadTexture("spark_flame.png");
-			TextureLoaded = true;
-		}
-	}
-
-	bool Update(float dt) {
-		transform.position = Vector2Add(transform.position, Vector2Scale(physics.velocity, dt));
-		if (type == WeaponType::GRENADES|| type == WeaponType::SHRAPNEL || type == WeaponType::EXPLOSION) {
-			time += dt;
-		}
-		else if (type == WeaponType::EXMISSILE) {
-			explodeRadius = explodeRadius + 60*dt;
-		}
-		if (transform.position.x < 0 ||
-			transform.position.x > Renderer::Instance().Width() ||
-			transform.position.y < 0 ||
-			transform.position.y > Renderer::Instance().Height())
-		{
-			return true;
-		}
-		return false;
-	}
-
-	void Draw() const {
-		Rectangle source = { 9.0f, 9.0f, static_cast<float>(textureMissile.width)-18.0f, static_cast<float>(textureMissile.height)-18.0f };
-		if (type == WeaponType::BULLET) {
-			DrawCircleV(transform.position, 5.f, WHITE);
-		}
-		else if (type == WeaponType::LASER) {
-			static constexpr float LASER_LENGTH = 30.f;
-			Rectangle lr = { transform.position.x - 2.f, transform.position.y - LASER_LENGTH, 4.f, LASER_LENGTH };
-			DrawRectangleRec(lr, RED);
-		}
-		else if(type == WeaponType::GRENADES ) {
-			DrawCircleV(transform.position, 5.f, GREEN);
-		}
-		else if (type == WeaponType::MISSILE )
-		{
-				static constexpr float MISSILE_LENGTH = 20.f;
-				DrawTriangle(
-					{ transform.position.x, transform.position.y - MISSILE_LENGTH },
-					{ transform.position.x - 5.f, transform.position.y },
-					{ transform.position.x + 5.f, transform.position.y },
-					BLUE
-				);
-		}
-		else if (type == WeaponType::SHRAPNEL) {
-			DrawCircleV(transform.position, 5.f, RED);
-		}
-		else if (type == WeaponType::EXMISSILE) {
-			Rectangle dest = { transform.position.x , transform.position.y , GetRadius() *2, GetRadius() * 2 };
-			Vector2 origin = { GetRadius(), GetRadius() };
-			DrawTexturePro(textureMissile, source, dest, origin, 0.0f, WHITE);
-		}
-		else if (type == WeaponType::EXPLOSION) {
+struct ProjectileStyle {
+	ProjectileLook look;
+	Color color;
+};
 
-			Rectangle dest = { transform.position.x , transform.position.y , GetRadius() * 2, GetRadius() * 2 };
-			Vector2 origin = { GetRadius(), GetRadius() };
-			DrawTexturePro(textureMissile, source, dest, origin, 0.0f, WHITE);
-		}
-	}
-	Vector2 GetPosition() const {
-		return transform.position;
-	}
+static constexpr ProjectileStyle projectileStyles[C_WEAPON_COUNT] = {
+	/* LASER     */ { ProjectileLook::LASER, RED },
+	/* BULLET    */ { ProjectileLook::DISC, WHITE },
+	/* MISSILE   */ { ProjectileLook::MISSILE, BLUE },
+	/* GRENADES  */ { ProjectileLook::DISC, GREEN },
+	/* SHRAPNEL  */ { ProjectileLook::DISC, RED },
+	/* EXMISSILE */ { ProjectileLook::NONE, BLANK },
+	/* EXPLOSION */ { ProjectileLook::NONE, BLANK },
+};
 
-	float GetRadius() const {
-		if (type == WeaponType::LASER) {
-			return 5.0f;
-		}
-		else if (type == WeaponType::BULLET) {
-			return 2.0f;
-		}
-		else if (type == WeaponType::MISSILE) {
-			return 5.0f;
-		}
-		else if (type == WeaponType::GRENADES) {
-			return 5.0f;
-		}
-		else if (type == WeaponType::EXMISSILE) {
-			return explodeRadius;
-		}
-		else if (type == WeaponType::EXPLOSION) {
-			return 80.0f;
+static constexpr float C_PROJECTILE_DISC = 5.f;
+static constexpr float C_LASER_LENGTH = 30.f;
+static constexpr float C_MISSILE_LENGTH = 20.f;
+
+// Draw system for one weapon's batch of projectiles, specialized per look
+template <WeaponType W>
+static void DrawProjectileBatch(const ProjectileArchetype& projectiles, std::span<const uint32_t> rows, const Box& view, float alpha, DrawQueue& queue) {
+	constexpr ProjectileStyle style = projectileStyles[static_cast<size_t>(W)];
+	if constexpr (style.look != ProjectileLook::NONE) {
+		const TransformA* current = projectiles.Column<TransformA>();
+		const PrevTransform* prev = projectiles.Column<PrevTransform>();
+		for (uint32_t i : rows) {
+			const Vector2 position = Interpolate(prev[i], current[i], alpha).position;
+			if (!InView(view, position, C_CULL_PAD)) continue;
+			if constexpr (style.look == ProjectileLook::DISC) {
+				queue.Circle(DrawLayer::PROJECTILES, position, C_PROJECTILE_DISC, style.color);
+			}
+			else if constexpr (style.look == ProjectileLook::LASER) {
+				Rectangle lr = { position.x - 2.f, position.y - C_LASER_LENGTH, 4.f, C_LASER_LENGTH };
+				queue.Rect(DrawLayer::PROJECTILES, lr, { 0, 0 }, 0.f, style.color);
+			}
+			else {
+				queue.Triangle(DrawLayer::PROJECTILES,
+					{ position.x, position.y - C_MISSILE_LENGTH },
+					{ position.x - 5.f, position.y },
+					{ position.x + 5.f, position.y },
+					style.color
+				);
+			}
 		}
-		else return 5.0f;
-
 	}
+}
 
-	int GetDamage() const {
-		return baseDamage;
-	}
-	float GetTime() const {
-		return time;
-
-	}
-	WeaponType GetWeaponType() const { 
-		return type;
-	}
-private:
-	float time = 0.0f;
-	float explodeRadius;
-	TransformA transform;
-	Physics    physics;
-	int        baseDamage;
-	WeaponType type;
-
-	static bool TextureLoaded;
-	static Texture textureMissile;
-};
-
-bool Projectile::TextureLoaded = false;
-Texture Projectile::textureMissile = { 0 };
+// Draw system for projectiles, weapon by weapon
+static void DrawProjectiles(const ProjectileArchetype& projectiles, const WeaponBatches& batches, const Box& view, float alpha, DrawQueue& queue) {
+	ForEachWeaponType([&]<WeaponType W>() {
+		DrawProjectileBatch<W>(projectiles, batches.Rows(W), view, alpha, queue);
+	});
+}
 
-inline static Projectile MakeProjectile(WeaponType wt, const Vector2 pos, Vector2 speed)
-{	
-	if (wt == WeaponType::LASER) {
-		return Projectile(pos, speed, 20, wt);
-	}
-	else if(wt == WeaponType::BULLET){
-		return Projectile(pos, speed, 10, wt);
-	}
-	else if (wt == WeaponType::MISSILE) {
-		return Projectile(pos, speed, 20, wt);
-	}
-	else if (wt == WeaponType::GRENADES) {
-		return Projectile(pos, speed, 20, wt);
-	}
-	else if (wt == WeaponType::SHRAPNEL) {
-		return Projectile(pos, speed, 20, wt);
-	}
-	else if (wt == WeaponType::EXPLOSION) {
-		return Projectile(pos, speed, 20, wt);
-	}
-	else if (wt == WeaponType::EXMISSILE) {
-		return Projectile(pos, speed, 20, wt);
-	}
-	else {
-		return Projectile(pos, speed, 20, wt);
+// Where and how a particle is drawn this frame: stepped back along its velocity for
+// interpolation, size and color lerped over its life
+static SpriteInstance ParticleInstance(const ParticlePool& particles, size_t i, float alpha, Rectangle source) {
+	const ParticleStyle& style = particles.Style(particles.StyleIndex()[i]);
+	const float t = particles.Age()[i] / particles.Life()[i];
+	const float back = (1.f - alpha) * World::C_FIXED_DT;
+	const float size = Lerp(style.sizeStart, style.sizeEnd, t);
+	auto mix = [t](uint8_t a, uint8_t b) { return static_cast<unsigned char>(a + (b - a) * t); };
+	return {
+		{ particles.X()[i] - particles.VX()[i] * back, particles.Y()[i] - particles.VY()[i] * back },
+		particles.Rotation()[i],
+		{ size, size },
+		Color{ mix(style.colorStart.r, style.colorEnd.r), mix(style.colorStart.g, style.colorEnd.g),
+			mix(style.colorStart.b, style.colorEnd.b), mix(style.colorStart.a, style.colorEnd.a) },
+		source
+	};
+}
 
+// Draw system for particles; flames are plain squares until their sprite loads
+static void DrawParticles(const ParticlePool& particles, const Sprites& sprites, const Box& view, float alpha, DrawQueue& queue) {
+	const SpriteHandle flame = sprites.Get(TextureId::SPARK_FLAME);
+	const Rectangle flameSize = sprites.cache->Source(flame);
+	const Rectangle source = sprites.cache->AtlasSource(flame, { 9.0f, 9.0f, flameSize.width - 18.0f, flameSize.height - 18.0f });
+	const bool flameReady = sprites.cache->Ready(flame);
+	for (size_t i = 0; i < particles.Size(); i++) {
+		if (!InView(view, { particles.X()[i], particles.Y()[i] }, C_CULL_PAD)) continue;
+		const SpriteInstance p = ParticleInstance(particles, i, alpha, source);
+		const Rectangle dest = { p.position.x, p.position.y, p.scale.x * 2, p.scale.y * 2 };
+		if (flameReady && particles.Style(particles.StyleIndex()[i]).look == ParticleLook::FLAME) {
+			queue.Sprite(DrawLayer::PARTICLES, sprites.cache->Atlas(), source, dest, p.scale, p.rotation, p.color);
+		}
+		else {
+			queue.Rect(DrawLayer::PARTICLES, dest, p.scale, p.rotation, p.color);
+		}
 	}
-	}
+}
 
-// --- SHIP HIERARCHY ---
-class Ship {
+// --- INSTANCED ENTITY DRAWING ---
+// Same pictures as DrawProjectiles / DrawAsteroids through InstancedRenderer:
+// one draw call per projectile look and per asteroid kind, whatever the counts
+class EntityBatches {
 public:
-	Ship(int screenW, int screenH) {
-		transform.position = {
-			 screenW * 0.5f,
-			 screenH * 0.5f
+	void Init(const Sprites& sprites) {
+		using Mesh = InstancedRenderer::Mesh;
+		renderer.Init();
+		// Projectiles first, asteroids on top, as in the immediate path
+		disc = renderer.AddBatch(Mesh::DISC, 0);
+		laser = renderer.AddBatch(Mesh::QUAD, 0);
+		missile = renderer.AddBatch(Mesh::ARROW, 0);
+		// Sprites share the atlas but keep their own batch, so draw order stays per look
+		cache = sprites.cache;
+		const Texture2D& atlas = cache->Atlas();
+		for (size_t k = 0; k < std::size(asteroidKinds); k++) {
+			const AsteroidKind& kind = asteroidKinds[k];
+			if (kind.texture != TextureId::NONE) {
+				const SpriteHandle sprite = sprites.Get(kind.texture);
+				const Rectangle rect = cache->Source(sprite);
+				asteroidSprite[k] = sprite;
+				asteroidBatch[k] = renderer.AddBatch(Mesh::QUAD, atlas.id);
+				asteroidAspect[k] = rect.height / rect.width;
+				asteroidSource[k] = cache->SourceNormalized(sprite);
+			}
+			else {
+				const Mesh outline = kind.sides == 3 ? Mesh::TRIANGLE_OUTLINE : kind.sides == 4 ? Mesh::SQUARE_OUTLINE : Mesh::PENTAGON_OUTLINE;
+				asteroidBatch[k] = renderer.AddBatch(outline, 0);
+			}
+		}
+		// Stands in for sprites still loading
+		placeholder = renderer.AddBatch(Mesh::PENTAGON_OUTLINE, 0);
+		// Particles over everything
+		flameSprite = sprites.Get(TextureId::SPARK_FLAME);
+		const Rectangle flameRect = cache->Source(flameSprite);
+		flame = renderer.AddBatch(Mesh::QUAD, atlas.id);
+		flameSource = {
+			(flameRect.x + 9.0f) / atlas.width, (flameRect.y + 9.0f) / atlas.height,
+			(flameRect.width - 18.0f) / atlas.width, (flameRect.height - 18.0f) / atlas.height
 		};
-		hp = 100;
-		speed = 250.f;
-		alive = true;
-
-		// per-weapon fire rate & spacing
-		fireRateLaser = 18.f; // shots/sec
-		fireRateBullet = 22.f;
-		fireRateMissile = 3.0f;
-		fireRateGrenades = 3.0f;
-		fireRateShrapnel = 4.0f;
-		fireRateExMissile = 1.0f;
-		fireRateExplosion = 1.0f;
-
-		spacingLaser = 40.f; // px between lasers
-		spacingBullet = 20.f;
-		spacingMissile = 100.f;
-		spacingGrenades = 100.0f;
-		spacingShrapnel = 80.0f;
-		spacingExMissile = 100.0f;
-		spacingExplosion = 100.0f;
+		square = renderer.AddBatch(Mesh::QUAD, 0);
 	}
-	virtual ~Ship() = default;
-	virtual void Update(float dt) = 0;
-	virtual void Draw() const = 0;
 
-	void TakeDamage(int dmg) {
-		if (!alive) return;
-		hp -= dmg;
-		if (hp <= 0) alive = false;
-	}
-	void BuffHp(int hpBuff) {
-		hp += hpBuff;
-	}
-	bool IsAlive() const {
-		return alive;
+	void Unload() {
+		renderer.Unload();
 	}
 
-	Vector2 GetPosition() const {
-		return transform.position;
+	void Draw(const World& world, const Box& view, float alpha) {
+		ForEachWeaponType([&]<WeaponType W>() {
+			SubmitProjectiles<W>(world.GetProjectiles(), world.GetProjectileBatches().Rows(W), view, alpha);
+		});
+		SubmitAsteroids(world.GetAsteroids(), view, alpha);
+		SubmitParticles(world.GetParticles(), view, alpha);
+		renderer.Flush();
 	}
 
-	virtual float GetRadius() const = 0;
-
-	int GetHP() const {
-		return hp;
+	int GetDrawCalls() const {
+		return renderer.GetDrawCalls();
 	}
 
-	float GetFireRate(WeaponType wt) const {
-		if(wt == WeaponType::LASER){
-			return fireRateLaser;
-		}
-		else if (wt == WeaponType::BULLET) {
-			return fireRateBullet;
-		}
-		else if (wt == WeaponType::MISSILE) {
-			return fireRateMissile;
-		}
-		else if (wt == WeaponType::GRENADES) {
-			return fireRateGrenades;
-		}
-		else if (wt == WeaponType::SHRAPNEL) {
-			return fireRateShrapnel;
-		}
-		else if (wt == WeaponType::EXMISSILE) {
-			return fireRateExMissile; //
-		}
-		else if (wt == WeaponType::EXPLOSION) {
-			return fireRateShrapnel; //
+private:
+	template <WeaponType W>
+	void SubmitProjectiles(const ProjectileArchetype& projectiles, std::span<const uint32_t> rows, const Box& view, float alpha) {
+		constexpr ProjectileStyle style = projectileStyles[static_cast<size_t>(W)];
+		if constexpr (style.look != ProjectileLook::NONE) {
+			const TransformA* current = projectiles.Column<TransformA>();
+			const PrevTransform* prev = projectiles.Column<PrevTransform>();
+			const Rectangle full = { 0, 0, 1, 1 };
+			for (uint32_t i : rows) {
+				const Vector2 position = Interpolate(prev[i], current[i], alpha).position;
+				if (!InView(view, position, C_CULL_PAD)) continue;
+				if constexpr (style.look == ProjectileLook::DISC) {
+					renderer.Submit(disc, { position, 0.f, { C_PROJECTILE_DISC, C_PROJECTILE_DISC }, style.color, full });
+				}
+				else if constexpr (style.look == ProjectileLook::LASER) {
+					renderer.Submit(laser, { { position.x, position.y - C_LASER_LENGTH * 0.5f }, 0.f, { 2.f, C_LASER_LENGTH * 0.5f }, style.color, full });
+				}
+				else {
+					renderer.Submit(missile, { position, 0.f, { 5.f, C_MISSILE_LENGTH }, style.color, full });
+				}
+			}
 		}
-		else return 5.0f;
 	}
 
-	float GetSpacing(WeaponType wt) const {
-		if (wt == WeaponType::LASER) {
-			return spacingLaser;
-		}
-		else if (wt == WeaponType::BULLET) {
-			return spacingBullet;
-		}
-		else if (wt == WeaponType::MISSILE) {
-			return spacingMissile;
-		}
-		else if (wt == WeaponType::GRENADES) {
-			return spacingGrenades;
-		}
-		else if (wt == WeaponType::SHRAPNEL) {
-			return spacingShrapnel;
-		}
-		else if (wt == WeaponType::EXMISSILE) {
-			return spacingExMissile;
-		}
-		else if (wt == WeaponType::EXPLOSION) {
-			return spacingExplosion;
+	void SubmitParticles(const ParticlePool& particles, const Box& view, float alpha) {
+		const Rectangle full = { 0, 0, 1, 1 };
+		const bool flameReady = cache->Ready(flameSprite);
+		for (size_t i = 0; i < particles.Size(); i++) {
+			if (!InView(view, { particles.X()[i], particles.Y()[i] }, C_CULL_PAD)) continue;
+			if (flameReady && particles.Style(particles.StyleIndex()[i]).look == ParticleLook::FLAME) {
+				renderer.Submit(flame, ParticleInstance(particles, i, alpha, flameSource));
+			}
+			else {
+				renderer.Submit(square, ParticleInstance(particles, i, alpha, full));
+			}
 		}
-		else return 100.0f;
 	}
 
-protected:
-	TransformA transform;
-	int        hp;
-	float      speed;
-	bool       alive;
-	float      fireRateLaser;
-	float      fireRateBullet;
-	float      fireRateMissile;
-	float		fireRateGrenades;
-	float		fireRateShrapnel;
-	float fireRateExMissile;
-	float fireRateExplosion;
+	void SubmitAsteroids(const AsteroidArchetype& asteroids, const Box& view, float alpha) {
+		const TransformA* current = asteroids.Column<TransformA>();
+		const PrevTransform* prev = asteroids.Column<PrevTransform>();
+		const Collider* collider = asteroids.Column<Collider>();
+		const AsteroidData* data = asteroids.Column<AsteroidData>();
+		bool ready[std::size(asteroidKinds)];
+		for (size_t k = 0; k < std::size(asteroidKinds); k++) {
+			ready[k] = !asteroidSprite[k].Valid() || cache->Ready(asteroidSprite[k]);
+		}
+		for (size_t i = 0; i < asteroids.Size(); i++) {
+			const uint8_t k = data[i].kind;
+			const float radius = collider[i].radius;
+			const TransformA transform = Interpolate(prev[i], current[i], alpha);
+			if (!InView(view, transform.position, radius)) continue;
+			if (!ready[k]) {
+				renderer.Submit(placeholder, { transform.position, transform.rotation, { radius, radius }, C_PLACEHOLDER, { 0, 0, 1, 1 } });
+				continue;
+			}
+			renderer.Submit(asteroidBatch[k], { transform.position, transform.rotation, { radius, radius * asteroidAspect[k] }, WHITE, asteroidSource[k] });
+		}
+	}
 
-	float      spacingLaser;
-	float      spacingBullet;
-	float	  spacingMissile;
-	float		spacingGrenades;
-	float		spacingShrapnel;
-	float	spacingExMissile;
-	float	spacingExplosion;
+	InstancedRenderer renderer;
+	const ResourceCache* cache = nullptr;
+	int disc = 0, laser = 0, missile = 0, flame = 0, square = 0, placeholder = 0;
+	SpriteHandle flameSprite;
+	Rectangle flameSource{};
+	SpriteHandle asteroidSprite[std::size(asteroidKinds)];   // invalid for outline kinds
+	int asteroidBatch[std::size(asteroidKinds)] = {};
+	float asteroidAspect[std::size(asteroidKinds)] = { 1.f, 1.f, 1.f, 1.f };
+	Rectangle asteroidSource[std::size(asteroidKinds)] = { { 0, 0, 1, 1 }, { 0, 0, 1, 1 }, { 0, 0, 1, 1 }, { 0, 0, 1, 1 } };
 };
 
-class PlayerShip :public Ship {
+// --- PLAYER SHIP ---
+// Visual side of the simulated Ship: character sprites and the death sprite.
+// All of them are held for the ship's lifetime, switching is a handle swap
+class PlayerShip {
 public:
-	PlayerShip(int w, int h) : Ship(w, h) {
-		currentCharacter = Character::PIBBLE;
-		texture = LoadTexture("pibb.png");
-		texture2 = LoadTexture("sleepy.png");
-		GenTextureMipmaps(&texture);                                                        // Generate GPU mipmaps for a texture
-		SetTextureFilter(texture, 2);
-		GenTextureMipmaps(&texture);                                                        // Generate GPU mipmaps for a texture
-		SetTextureFilter(texture, 2);
-		scale = 0.25f;
-		size = static_cast<float>(texture.width) * scale;
-
+	explicit PlayerShip(ResourceCache& resources) : cache(resources) {
+		characters[static_cast<int>(Character::PIBBLE)] = cache.Acquire("pibb.png");
+		characters[static_cast<int>(Character::WASHINGTON)] = cache.Acquire("washington.png");
+		characters[static_cast<int>(Character::GMAIL)] = cache.Acquire("gmail.png");
+		sleepy = cache.Acquire("sleepy.png");
+		size = cache.Source(characters[static_cast<int>(Character::PIBBLE)]).width * 0.25f;
+		SetCharacter(Character::PIBBLE);
 	}
 	~PlayerShip() {
-		UnloadTexture(texture);
-	}
-
-	void Update(float dt) override {
-		if (alive) {
-			if (IsKeyDown(KEY_W)) transform.position.y -= speed * dt;
-			if (IsKeyDown(KEY_S)) transform.position.y += speed * dt;
-			if (IsKeyDown(KEY_A)) transform.position.x -= speed * dt;
-			if (IsKeyDown(KEY_D)) transform.position.x += speed * dt;
-		}
-		else {
-			transform.position.y += speed * dt;
+		for (SpriteHandle h : characters) {
+			cache.Release(h);
 		}
+		cache.Release(sleepy);
 	}
 
 	void SetCharacter(Character cc) {
-			UnloadTexture(texture);
+		currentCharacter = cc;
+		sprite = characters[static_cast<int>(cc)];
 		if (cc == Character::PIBBLE) {
-			hp = 100.0f;
-			speed = 250.0f;
-			texture = LoadTexture("pibb.png");
 			scale = 0.25f;
 		}
-		else if (cc ==Character::WASHINGTON){
-			hp = 50.0f;
-			speed = 400.0f;
-			texture = LoadTexture("washington.png");
-			scale = size / texture.width;
-		}
 		else {
-			hp = 75.0f;
-			speed = 350.0f;
-			texture = LoadTexture("gmail.png");
-			scale = size / texture.width;
+			scale = size / cache.Source(sprite).width;
 		}
-			GenTextureMipmaps(&texture);                                                        // Generate GPU mipmaps for a texture
-			SetTextureFilter(texture, 2);
 	};
 
-	void Draw() const override {
-		if (!alive && fmodf(GetTime(), 0.4f) > 0.2f) return;
+	Character GetCharacter() const {
+		return currentCharacter;
+	}
+
+	void Draw(const Ship& ship, float alpha, DrawQueue& queue) const {
+		if (!ship.IsAlive() && fmodf(GetTime(), 0.4f) > 0.2f) return;
+		const Rectangle rect = cache.Source(sprite);
+		const Vector2 position = ship.GetPosition(alpha);
 		Vector2 dstPos = {
-										 transform.position.x - (texture.width * scale) * 0.5f,
-										 transform.position.y - (texture.height * scale) * 0.5f
+										 position.x - (rect.width * scale) * 0.5f,
+										 position.y - (rect.height * scale) * 0.5f
 		};
-		if (alive) {
-			DrawTextureEx(texture, dstPos, 0.0f, scale, WHITE);
-		}
-		else {
-			float scale2 = static_cast<float>(texture.width) / texture2.width * scale;
-			DrawTextureEx(texture2, dstPos, 0.0f, scale2, WHITE);
+		const SpriteHandle shown = ship.IsAlive() ? sprite : sleepy;
+		if (!cache.Ready(shown)) {
+			queue.PolyLines(DrawLayer::PLAYER, position, 3, GetRadius(), -90.f, C_PLACEHOLDER);
+			return;
 		}
+		const Rectangle source = cache.Source(shown);
+		const float shownScale = ship.IsAlive() ? scale : rect.width / source.width * scale;
+		queue.Sprite(DrawLayer::PLAYER, cache.Atlas(), source,
+			{ dstPos.x, dstPos.y, source.width * shownScale, source.height * shownScale }, { 0, 0 }, 0.0f, WHITE);
 	}
 
-	float GetRadius() const override {
-		return (texture.width * scale ) * 0.5f;
+	float GetRadius() const {
+		return (cache.Source(sprite).width * scale ) * 0.5f;
 	}
 
 private:
-	Texture2D texture, texture2;
+	ResourceCache& cache;
+	SpriteHandle characters[static_cast<int>(Character::COUNT)];
+	SpriteHandle sprite, sleepy;
 	float     scale;
 	float size;
 	Character currentCharacter;
@@ -619,21 +448,18 @@ private:
 // Adds
 class Adds {
 public:
-	Adds() {
+	explicit Adds(ResourceCache& resources) : cache(resources) {
 		paused = false;
 		timer = 0;
-		image1 = LoadTexture("add1.png");
-		image2 = LoadTexture("add2.png");
+		image1 = cache.Acquire("add1.png");
+		image2 = cache.Acquire("add2.png");
 
 	}
 	~Adds() {
-		UnloadTexture(image1);
-		UnloadTexture(image2);
+		cache.Release(image1);
+		cache.Release(image2);
 	}
 
-	int GetHpBuff() const {
-		return hpBuff;
-	}
 	void WatchAdd() {
 		timer = 0;
 		paused = true;
@@ -651,29 +477,110 @@ public:
 	}
 	void Draw(int w, int h) const{
 		if (!paused) return;
-		Texture2D currentImage;
+		SpriteHandle currentImage;
 		if (timer < maxTime * 0.5f) {
 			currentImage = image1;
 		}
 		else {
 			currentImage = image2;
 		}
-		Rectangle source = { 0, 0, static_cast<float>(currentImage.width), static_cast<float>(currentImage.height) };
-		Rectangle dest = { 0 , 0,static_cast<float>(w), static_cast<float>(h) };
-		Vector2 origin = { 0, 0 };
-		DrawTexturePro(currentImage, source, dest, origin, 0.0f, WHITE);
+		if (cache.Ready(currentImage)) {
+			const Rectangle size = cache.Source(currentImage);
+			Rectangle source = { 0, 0, size.width, size.height };
+			Rectangle dest = { 0 , 0,static_cast<float>(w), static_cast<float>(h) };
+			Vector2 origin = { 0, 0 };
+			cache.Draw(currentImage, source, dest, origin, 0.0f, WHITE);
+		}
+		else {
+			DrawRectangle(0, 0, w, h, DARKGRAY);
+		}
 		DrawText(TextFormat("Reklama"),
 			10, 40, 20, BLUE);
 	}
 private:
-	const int hpBuff = 20;
 	bool paused;
 	float timer;
-	Texture2D image1, image2;
+	ResourceCache& cache;
+	SpriteHandle image1, image2;
 	const float maxTime = 5.0f;
 
 };
 
+// --- SOUND ---
+// What each weapon sounds like when its projectiles appear; shrapnel is heard
+// through the explosion that throws it
+static constexpr SoundId weaponSounds[C_WEAPON_COUNT] = {
+	/* LASER     */ SoundId::LASER,
+	/* BULLET    */ SoundId::BULLET,
+	/* MISSILE   */ SoundId::MISSILE,
+	/* GRENADES  */ SoundId::GRENADE,
+	/* SHRAPNEL  */ SoundId::NONE,
+	/* EXMISSILE */ SoundId::BLAST,
+	/* EXPLOSION */ SoundId::EXPLOSION,
+};
+
+// Sounds fade out over this distance from the middle of the view
+static constexpr float C_HEARING_RANGE = 900.f;
+
+// Turns the cues of this frame's steps into triggers and hands them to the mixer
+static void PlayCues(World& world, Mixer& mixer) {
+	const Box view = world.GetView();
+	mixer.SetListener(Vector2Lerp(view.min, view.max, 0.5f), C_HEARING_RANGE);
+	for (const Cue& cue : world.GetCues()) {
+		const SoundId sound = cue.kind == Cue::PROJECTILE ? weaponSounds[static_cast<size_t>(cue.weapon)] : SoundId::ASTEROID;
+		mixer.Trigger(sound, cue.position);
+	}
+	world.ClearCues();
+	mixer.EndFrame();
+}
+
+// Milliseconds from process start, negative until it happened
+struct StartupTimes {
+	double firstFrameMs = -1.0;   // first frame presented with input live
+	double assetsMs = -1.0;       // last sprite uploaded
+};
+
+// --- PROFILER OVERLAY ---
+// F3: rolling per-zone frame times and what is alive right now
+static void DrawProfilerOverlay(const World& world, int drawCalls, const DrawQueue::Stats& queued, bool capturing, const StartupTimes& startup,
+	size_t assetsPending, FrameArena& arena) {
+	const std::pmr::vector<Profiler::Stats> stats = Profiler::Instance().GetStats(&arena);
+	const int x = 10, lineH = 14, w = 330;
+	int y = 70;
+	DrawRectangle(x - 5, y - 5, w, static_cast<int>(stats.size() + 8) * lineH + 10, Color{ 0, 0, 0, 180 });
+	DrawText(TextFormat("%d fps  ast %zu  proj %zu  part %zu  draws %d%s", GetFPS(), world.GetAsteroids().Size(),
+		world.GetProjectiles().Size(), world.GetParticles().Size(), drawCalls, capturing ? "  [REC]" : ""), x, y, 10, YELLOW);
+	y += lineH;
+	DrawText(TextFormat("sim %u thread(s), %s kernels, %zu asteroids asleep", world.GetThreadCount(), Kernels::IntegrateName(),
+		world.GetSleepingAsteroids()), x, y, 10, YELLOW);
+	y += lineH;
+	DrawText(TextFormat("rewind %zu/%zu snapshots, %zu KB", world.GetRewind().Size(), world.GetRewind().Capacity(),
+		world.GetRewind().Bytes() >> 10), x, y, 10, YELLOW);
+	y += lineH;
+	if (assetsPending > 0) {
+		DrawText(TextFormat("startup %.0f ms to first frame, %zu sprite(s) loading", startup.firstFrameMs, assetsPending), x, y, 10, YELLOW);
+	}
+	else {
+		DrawText(TextFormat("startup %.0f ms to first frame, %.0f ms to all sprites", startup.firstFrameMs, startup.assetsMs), x, y, 10, YELLOW);
+	}
+	y += lineH;
+	const Mixer::Stats audio = Mixer::Instance().GetStats();
+	DrawText(TextFormat("audio %u/%zu voices  %llu merged  %llu stolen  %llu dropped", audio.voices, Mixer::VOICES,
+		static_cast<unsigned long long>(audio.merged), static_cast<unsigned long long>(audio.stolen),
+		static_cast<unsigned long long>(audio.dropped)), x, y, 10, YELLOW);
+	y += lineH;
+	DrawText(TextFormat("queue %d cmds  %d draws (%d unsorted)  %d flushes", queued.commands, queued.drawCalls,
+		queued.unsortedChanges, queued.flushes), x, y, 10, YELLOW);
+	y += lineH * 2;
+	DrawText("zone                     min      avg      p99  (ms)", x, y, 10, LIGHTGRAY);
+	y += lineH;
+	for (const Profiler::Stats& st : stats) {
+		DrawText(st.name, x, y, 10, WHITE);
+		DrawText(TextFormat("%8.3f %8.3f %8.3f", st.minMs, st.avgMs, st.p99Ms), x + 150, y, 10, WHITE);
+		y += lineH;
+	}
+}
+
 // --- APPLICATION ---
 class Application {
 public:
@@ -683,291 +590,382 @@ public:
 		return inst;
 	}
 
-	void Run() {
+	// Play normally, record every simulated frame, or play a recording back
+	struct Options {
+		std::string record;
+		std::string replay;
+		std::string tuning = "tuning.txt";   // read if it exists
+		std::string pack = "assets.pak";     // mapped if it exists
+	};
 
-		srand(static_cast<unsigned>(time(nullptr)));
+	void Run(const Options& options) {
 		Renderer::Instance().Init(C_WIDTH, C_HEIGHT, "Asteroids OOP");
-		auto player = std::make_unique <PlayerShip >(C_WIDTH, C_HEIGHT);
+		// Shipped builds read every asset out of one mapped pack; without one
+		// (development) the loose files next to the executable are used
+		if (pack.Open(options.pack.c_str())) {
+			TraceLog(LOG_INFO, "PACK: %s mapped, %zu assets", options.pack.c_str(), pack.Count());
+		}
+		else if (FileExists(options.pack.c_str())) {
+			TraceLog(LOG_WARNING, "PACK: %s is not a valid pack, using loose files", options.pack.c_str());
+		}
+		// Everything the game draws, read once into the atlas; decoded in the
+		// background and uploaded a little every frame from the first one on
+		resources.BuildAsync({
+			"pibb.png", "washington.png", "gmail.png", "sleepy.png", "geeble.png",
+			"spark_flame.png", "background.png", "add1.png", "add2.png"
+		}, C_DECODE_THREADS, &pack);
+		StartAudio();
+		queue.Init();
+		Play(options);
+		queue.Unload();
+		StopAudio();
+		resources.Unload();
+		pack.Close();
+	}
 
-		Adds adds;
+private:
+	Application() = default;
+
+	// Game loop; everything holding sprites lives in here and is gone before the atlas
+	void Play(const Options& options) {
+		PlayerShip playerSprite(resources);
+		sprites.Load(resources);
+		bool instanced = InstancedRenderer::Supported();
+		if (instanced) {
+			batches.Init(sprites);
+		}
+
+		World::Config config;
+		config.width = C_WIDTH;
+		config.height = C_HEIGHT;
+		config.arenaWidth = C_WIDTH * C_ARENA_VIEWS;
+		config.arenaHeight = C_HEIGHT * C_ARENA_VIEWS;
+		config.arenaAsteroids = C_ARENA_ASTEROIDS;
+		config.maxAsteroids = MAX_AST;
+		config.playerRadius = playerSprite.GetRadius();
+		config.threads = 0;
+		config.seed = static_cast<uint32_t>(time(nullptr));
+		config.rewindSeconds = C_REWIND_SECONDS;
+		if (FileExists(options.tuning.c_str())) {
+			int line = 0;
+			if (config.tuning.Load(options.tuning.c_str(), &line)) {
+				TraceLog(LOG_INFO, "TUNING: loaded %s", options.tuning.c_str());
+			}
+			else {
+				TraceLog(LOG_WARNING, "TUNING: %s line %d not understood, using the defaults", options.tuning.c_str(), line);
+			}
+		}
+
+		// A replay brings its own world size, seed and tuning; the keyboard only
+		// drives the window then
+		ReplayFile recording, replay;
+		if (!options.replay.empty()) {
+			if (replay.OpenRead(options.replay.c_str())) {
+				replay.Header().Apply(config);
+				TraceLog(LOG_INFO, "REPLAY: playing %s, %u frames", options.replay.c_str(), replay.Header().frameCount);
+			}
+			else {
+				TraceLog(LOG_WARNING, "REPLAY: cannot read %s", options.replay.c_str());
+			}
+		}
+		else if (!options.record.empty()) {
+			if (!recording.OpenWrite(options.record.c_str(), ReplayHeader::FromConfig(config))) {
+				TraceLog(LOG_WARNING, "REPLAY: cannot write %s", options.record.c_str());
+			}
+		}
+		World world(config);
 
-		float spawnTimer = 0.f;
-		float spawnInterval = Utils::RandomFloat(C_SPAWN_MIN, C_SPAWN_MAX);
-		WeaponType currentWeapon = WeaponType::LASER;
-		float shotTimer = 0.f;
-		textureBackground = LoadTexture("background.png");
+		Adds adds(resources);
 
+		background = resources.Acquire("background.png");
+
+		bool overlay = false;
+		StartupTimes startup;
+#if HEAP_CHECK
+		HeapCheck::SteadyState heapCheck;
+#endif
 		while (!WindowShouldClose()) {
+			PROFILE_END_FRAME();
+			frameArena.Reset();
+#if HEAP_CHECK
+			if (heapCheck.Frame()) {
+				TraceLog(LOG_WARNING, "HEAP: %llu allocation(s) in %llu steady-state frame(s)",
+					static_cast<unsigned long long>(heapCheck.Allocations()), static_cast<unsigned long long>(heapCheck.Frames()));
+			}
+#endif
+			{
+				PROFILE_SCOPE("upload assets");
+				if (resources.Pump(C_UPLOAD_BUDGET_MS) && startup.assetsMs < 0.0) {
+					startup.assetsMs = MsSinceProcessStart();
+					TraceLog(LOG_INFO, "STARTUP: every sprite ready %.1f ms after process start", startup.assetsMs);
+				}
+			}
 			float dt = GetFrameTime();
-			spawnTimer += dt;
+			InputState input;
+			{
+				PROFILE_SCOPE("poll input");
+				input = PollInput();
+			}
 
-		if (IsKeyPressed(KEY_T) && !adds.IsPaused() && player->IsAlive()) {
-			adds.WatchAdd();
-			player->BuffHp(adds.GetHpBuff());
-		}
+			// Profiler overlay and trace capture (trace.json for Perfetto, profile.csv per frame)
+			if (IsKeyPressed(KEY_F3)) {
+				overlay = !overlay;
+			}
+			if (IsKeyPressed(KEY_F4)) {
+				Profiler& profiler = Profiler::Instance();
+				if (!profiler.IsCapturing()) profiler.BeginCapture();
+				else profiler.EndCapture("trace.json", "profile.csv");
+			}
 
 		if (adds.IsPaused()) {
 			adds.Update(dt);
 			Renderer::Instance().Begin();
 			adds.Draw(C_WIDTH, C_HEIGHT);
 			Renderer::Instance().End();
+			FirstFrame(startup);
 
 			continue; 
 		}
 
-			// Update player
-			player->Update(dt);
-			// Restart logic
-			if (!player->IsAlive() && IsKeyPressed(KEY_R)) {
-				player = std::make_unique<PlayerShip>(C_WIDTH, C_HEIGHT);
-				asteroids.clear();
-				projectiles.clear();
-				spawnTimer = 0.f;
-				spawnInterval = Utils::RandomFloat(C_SPAWN_MIN, C_SPAWN_MAX);
-				currentCharacter = Character::PIBBLE;
-				currentWeapon = WeaponType::LASER;
-			}
-			// Asteroid shape switch
-			if (IsKeyPressed(KEY_ONE)) {
-				currentShape = AsteroidShape::TRIANGLE;
-			}
-			if (IsKeyPressed(KEY_TWO)) {
-				currentShape = AsteroidShape::SQUARE;
-			}
-			if (IsKeyPressed(KEY_THREE)) {
-				currentShape = AsteroidShape::PENTAGON;
-			}
-			if (IsKeyPressed(KEY_FOUR)) {
-				currentShape = AsteroidShape::RANDOM;
-			}
-			if (IsKeyPressed(KEY_FIVE)) {
-				currentShape = AsteroidShape::GEEBLE;
+			// Frames under an ad are not simulated, so they are neither recorded nor replayed
+			if (replay.IsOpen()) {
+				if (!replay.Next(input, dt)) {
+					TraceLog(LOG_INFO, "REPLAY: finished, checksum %08x", world.Checksum());
+					replay.Close();
+					break;
+				}
 			}
-
-			// Weapon switch
-			if (IsKeyPressed(KEY_TAB) && currentCharacter != Character::GMAIL) {
-				currentWeapon = static_cast<WeaponType>((static_cast<int>(currentWeapon) + 1) % (static_cast<int>(WeaponType::COUNT) - 4));
+			else if (recording.IsOpen()) {
+				recording.Write(input, dt);
 			}
 
-			//Change charracter
-			if (IsKeyPressed(KEY_F) && player->IsAlive())
+			// The world grants the ad's HP itself, so a replay gets it too
+			const bool adStarts = input.IsPressed(IN_WATCH_ADD) && world.GetPlayer().IsAlive();
 			{
-				Character previousCharacter = currentCharacter;
-				currentCharacter = static_cast<Character>((static_cast<int>(currentCharacter) + 1) % static_cast<int>(Character::COUNT));
-				player->SetCharacter(currentCharacter);
-				if (currentCharacter == Character::GMAIL) {
-					currentWeapon = WeaponType::GRENADES;
-				}
-				else if (previousCharacter == Character::GMAIL) {
-					currentWeapon = WeaponType::LASER;
-				}
-
+				PROFILE_SCOPE("simulate");
+				world.Advance(input, dt);
+			}
+			if (adStarts) {
+				adds.WatchAdd();
 			}
-
-			// Shooting
 			{
-				if (player->IsAlive() && IsKeyDown(KEY_SPACE)) {
-
-					Vector2 vel = {};
-					shotTimer += dt;
-					float interval = 1.f / player->GetFireRate(currentWeapon);
-					float projSpeed = player->GetSpacing(currentWeapon) * player->GetFireRate(currentWeapon);
-
-					while (shotTimer >= interval) {
-						Vector2 p = player->GetPosition();
-						p.y -= player->GetRadius();
-						if (currentWeapon != WeaponType::GRENADES)
-						{
-							vel = { 0, -projSpeed };
-							projectiles.push_back(MakeProjectile(currentWeapon, p, vel));
-						}
-						else 
-						{
-							vel = { -cosf(PI / 4) * projSpeed, -sinf(PI / 4) * projSpeed };
-							projectiles.push_back(MakeProjectile(currentWeapon, p, vel));
-							Vector2 vel2 = { cosf(PI / 4) * projSpeed, -sinf(PI / 4) * projSpeed };
-							projectiles.push_back(MakeProjectile(currentWeapon, p, vel2));
-						}
-						shotTimer -= interval;
-					}
-				}
-				else {
-					float maxInterval = 1.f / player->GetFireRate(currentWeapon);
-
-					if (shotTimer > maxInterval) {
-						shotTimer = fmodf(shotTimer, maxInterval);
-					}
-				}
+				PROFILE_SCOPE("sound");
+				PlayCues(world, Mixer::Instance());
 			}
+			const float alpha = world.GetAlpha();
+			// Fetched after stepping, a restart replaces the ship
+			const Ship& player = world.GetPlayer();
 
-			// Spawn asteroids
-			if (spawnTimer >= spawnInterval && asteroids.size() < MAX_AST) {
-				asteroids.push_back(MakeAsteroid(C_WIDTH, C_HEIGHT, currentShape));
-				spawnTimer = 0.f;
-				spawnInterval = Utils::RandomFloat(C_SPAWN_MIN, C_SPAWN_MAX);
+			// Instanced / immediate rendering, for comparing the two
+			if (IsKeyPressed(KEY_I) && InstancedRenderer::Supported()) {
+				instanced = !instanced;
 			}
 
-			// Update projectiles - check if in boundries and move them forward
-			{
-				auto projectile_to_remove = std::remove_if(projectiles.begin(), projectiles.end(),
-					[dt](auto& projectile) {
-						return projectile.Update(dt);
-					});
-				projectiles.erase(projectile_to_remove, projectiles.end());
+			// Character switch or restart
+			if (playerSprite.GetCharacter() != world.GetCurrentCharacter()) {
+				playerSprite.SetCharacter(world.GetCurrentCharacter());
 			}
 
-			// Projectile-Asteroid collisions O(n^2)
-			for (auto pit = projectiles.begin(); pit != projectiles.end();) {
-				bool removed = false;
-
-				if (IsKeyPressed(KEY_E)) {
-					if (pit->GetWeaponType() == WeaponType::MISSILE) {
-						projectiles.push_back(MakeProjectile(WeaponType::EXMISSILE, (*pit).GetPosition(), { 0.0f, 0.0f }));
-						pit = projectiles.erase(pit);
-						removed = true;
-						continue;
+			// Render everything; the world part through a camera that follows the ship
+			{
+					Renderer::Instance().Begin();
+					queue.BeginFrame();
+					const Box view = world.GetView(alpha);
+					Camera2D camera = {};
+					camera.target = view.min;
+					camera.zoom = 1.f;
+					BeginMode2D(camera);
+					{
+					PROFILE_SCOPE("render background");
+					// One screen-sized tile per view-sized cell of the arena the view touches,
+					// plain black until the picture has loaded
+					const Rectangle backgroundSize = resources.Source(background);
+					Rectangle source = { 0, 0, backgroundSize.width, backgroundSize.height };
+					const int tx0 = static_cast<int>(view.min.x) / C_WIDTH, tx1 = static_cast<int>(ceilf(view.max.x)) / C_WIDTH;
+					const int ty0 = static_cast<int>(view.min.y) / C_HEIGHT, ty1 = static_cast<int>(ceilf(view.max.y)) / C_HEIGHT;
+					for (int ty = ty0; ty <= ty1 && resources.Ready(background); ty++) {
+						for (int tx = tx0; tx <= tx1; tx++) {
+							Rectangle dest = { static_cast<float>(tx * C_WIDTH), static_cast<float>(ty * C_HEIGHT), static_cast<float>(C_WIDTH), static_cast<float>(C_HEIGHT) };
+							if (dest.x >= view.max.x || dest.y >= view.max.y) continue;
+							Vector2 origin = { 0, 0 };
+							queue.Sprite(DrawLayer::BACKGROUND, resources.Atlas(), resources.AtlasSource(background, source), dest, origin, 0.0f, Color{ 255, 255, 255, 130 });
+						}
 					}
-				}
-				else if ((*pit).GetWeaponType() == WeaponType::GRENADES && (*pit).GetTime() >= 40 * dt) {
-					for (int i = 0; i < shrapnel; i++) {
-						float angle = 0.0f;
-						angle = (2 * PI / shrapnel) * i;
-						float projSpeed = player->GetSpacing(currentWeapon) * player->GetFireRate(currentWeapon);
-						Vector2 vel = { cosf(angle) * projSpeed, sinf(angle) * projSpeed };
-						projectiles.push_back(MakeProjectile(WeaponType::SHRAPNEL, (*pit).GetPosition(), vel));
 					}
-					projectiles.push_back(MakeProjectile(WeaponType::EXPLOSION, (*pit).GetPosition(), { 0.0f, 0.0f }));
-					pit = projectiles.erase(pit);
-					removed = true;
-					continue;
-				}
-				else if ((*pit).GetWeaponType() == WeaponType::SHRAPNEL && (*pit).GetTime() >= 40 * dt) {
-					projectiles.push_back(MakeProjectile(WeaponType::EXPLOSION, (*pit).GetPosition(), { 0.0f, 0.0f }));
-					pit = projectiles.erase(pit);
-					removed = true;
-					continue;
-				}
-				else if ((*pit).GetWeaponType() == WeaponType::EXMISSILE && (*pit).GetRadius() >= 150.0f) {
-					pit = projectiles.erase(pit);
-					removed = true;
-					continue;
-				}
-				else if ((*pit).GetWeaponType() == WeaponType::EXPLOSION && (*pit).GetTime() >= 5 * dt) {
-					pit = projectiles.erase(pit);
-					removed = true;
-					continue;
-				}
-				for (auto ait = asteroids.begin(); ait != asteroids.end(); ++ait) {
-					float dist = Vector2Distance((*pit).GetPosition(), (*ait)->GetPosition());
 
-					if (dist < (*pit).GetRadius() + (*ait)->GetRadius()) {
-						(*ait)->TakeDamage((*pit).GetDamage());
-						if (pit->GetWeaponType() == WeaponType::MISSILE) {
-							projectiles.push_back(MakeProjectile(WeaponType::EXMISSILE, (*pit).GetPosition(), { 0.0f, 0.0f }));
+					{
+						PROFILE_SCOPE("render entities");
+						if (instanced) {
+							// The batches draw straight away, the background has to be down first
+							queue.Flush();
+							batches.Draw(world, view, alpha);
 						}
-						if (!(*ait)->IsAlive())
-						{
-							ait = asteroids.erase(ait);
-
+						else {
+							DrawProjectiles(world.GetProjectiles(), world.GetProjectileBatches(), view, alpha, queue);
+							DrawAsteroids(world.GetAsteroids(), sprites, view, alpha, queue);
+							DrawParticles(world.GetParticles(), sprites, view, alpha, queue);
 						}
-						pit = projectiles.erase(pit);
-						removed = true;
-						break;
 					}
-				}
-
-				if (!removed) {
-					++pit;
-				}
-			}
-
-			// Asteroid-Ship collisions
-			{
-				auto remove_collision = [&player, dt](auto& asteroid_ptr_like) -> bool {
-					if (player->IsAlive()) {
-						float dist = Vector2Distance(player->GetPosition(), asteroid_ptr_like->GetPosition());
 
-						if (dist < player->GetRadius() + asteroid_ptr_like->GetRadius()) {
-							player->TakeDamage(asteroid_ptr_like->GetDamage());
-							return true; // Mark asteroid for removal due to collision
-						}
-					}
-					if (!asteroid_ptr_like->Update(dt)) {
-						return true;
+					{
+						PROFILE_SCOPE("render player");
+						playerSprite.Draw(player, alpha, queue);
 					}
-					return false; // Keep the asteroid
-					};
-				auto asteroid_to_remove = std::remove_if(asteroids.begin(), asteroids.end(), remove_collision);
-				asteroids.erase(asteroid_to_remove, asteroids.end());
-			}
 
-			// Render everything
-			{
-					Renderer::Instance().Begin();
-					Rectangle source = { 0, 0, static_cast<float>(textureBackground.width), static_cast<float>(textureBackground.height) };
-					Rectangle dest = { 0, 0, static_cast<float>(C_WIDTH), static_cast<float>(C_HEIGHT) };
-					Vector2 origin = { 0, 0 };
-					DrawTexturePro(textureBackground, source, dest, origin, 0.0f, Color{ 255, 255, 255, 130 });
-					DrawText(TextFormat("HP: %d", player->GetHP()),
-						10, 10, 20, GREEN);
-					const char* weaponName = nullptr;
-					if ((currentWeapon == WeaponType::LASER)) {
-						weaponName = "Laser";
-					}
-					else if (currentWeapon == WeaponType::BULLET) {
-						weaponName = "Bullet";
-					}
-					else if (currentWeapon == WeaponType::MISSILE) {
-						weaponName = "Missile";
-					}
-					else if (currentWeapon == WeaponType::GRENADES) {
-						weaponName = "Grenades";
+					{
+						PROFILE_SCOPE("render flush");
+						queue.Flush();
 					}
+					EndMode2D();
 
-					DrawText(TextFormat("Weapon: %s", weaponName),
+					{
+					PROFILE_SCOPE("render hud");
+					DrawText(TextFormat("HP: %d", player.GetHP()),
+						10, 10, 20, GREEN);
+					static constexpr const char* weaponLabels[C_WEAPON_COUNT] = {
+						"Laser", "Bullet", "Missile", "Grenades", "Shrapnel", "Blast", "Explosion"
+					};
+					DrawText(TextFormat("Weapon: %s", weaponLabels[static_cast<size_t>(world.GetCurrentWeapon())]),
 						10, 40, 20, BLUE);
-
-					for (const auto& projPtr : projectiles) {
-						projPtr.Draw();
+					if (world.IsRewinding()) {
+						DrawText("<< REWIND", C_WIDTH - 130, 10, 20, ORANGE);
 					}
-					for (const auto& astPtr : asteroids) {
-						astPtr->Draw();
 					}
 
-					player->Draw();
+					if (overlay) {
+						PROFILE_SCOPE("render overlay");
+						DrawProfilerOverlay(world, instanced ? batches.GetDrawCalls() : -1, queue.GetStats(), Profiler::Instance().IsCapturing(),
+							startup, resources.Pending(), frameArena);
+					}
 
+					// Includes the wait for vsync
+					PROFILE_SCOPE("present");
 					Renderer::Instance().End();
 			}
+			FirstFrame(startup);
+		}
+		if (recording.IsOpen()) {
+			TraceLog(LOG_INFO, "REPLAY: recorded %u frames, checksum %08x", recording.Header().frameCount, world.Checksum());
+			recording.Close();
+		}
+		if (Profiler::Instance().IsCapturing()) {
+			Profiler::Instance().EndCapture("trace.json", "profile.csv");
+		}
+		if (InstancedRenderer::Supported()) {
+			batches.Unload();
+		}
+		sprites.Unload();
+		resources.Release(background);
+	}
+
+	// Every effect from the pack, a loose file or its synthesized patch, in that
+	// order, resident before the device's stream starts pulling from the mixer
+	void StartAudio() {
+		InitAudioDevice();
+		if (!IsAudioDeviceReady()) {
+			TraceLog(LOG_WARNING, "AUDIO: no device, the game stays silent");
+			return;
+		}
+		Mixer& mixer = Mixer::Instance();
+		int loaded = 0;
+		for (size_t s = 0; s < C_SOUND_COUNT; s++) {
+			const SoundId id = static_cast<SoundId>(s);
+			const char* file = soundInfos[s].file;
+			const std::span<const uint8_t> packed = pack.Find(file);
+			Wave wave = {};
+			if (!packed.empty()) wave = LoadWaveFromMemory(GetFileExtension(file), packed.data(), static_cast<int>(packed.size()));
+			else if (FileExists(file)) wave = LoadWave(file);
+			if (wave.data == nullptr) {
+				mixer.Synthesize(id);
+				continue;
+			}
+			WaveFormat(&wave, Mixer::SAMPLE_RATE, 32, 1);
+			const float* pcm = static_cast<const float*>(wave.data);
+			mixer.SetSound(id, std::vector<float>(pcm, pcm + wave.frameCount));
+			UnloadWave(wave);
+			loaded++;
+		}
+		TraceLog(LOG_INFO, "AUDIO: %d of %zu sounds loaded, the rest synthesized", loaded, C_SOUND_COUNT);
+		SetAudioStreamBufferSizeDefault(C_AUDIO_BUFFER_FRAMES);
+		audioStream = LoadAudioStream(Mixer::SAMPLE_RATE, 32, 2);
+		SetAudioStreamCallback(audioStream, [](void* buffer, unsigned int frames) {
+			Mixer::Instance().Mix(static_cast<float*>(buffer), frames);
+		});
+		PlayAudioStream(audioStream);
+	}
+
+	void StopAudio() {
+		if (!IsAudioDeviceReady()) return;
+		UnloadAudioStream(audioStream);
+		CloseAudioDevice();
+	}
+
+	// Call after presenting a frame; notes when the first one went out
+	static void FirstFrame(StartupTimes& startup) {
+		if (startup.firstFrameMs >= 0.0) return;
+		startup.firstFrameMs = MsSinceProcessStart();
+		TraceLog(LOG_INFO, "STARTUP: first interactive frame %.1f ms after process start", startup.firstFrameMs);
+	}
+
+	// Samples every key the simulation reacts to
+	static InputState PollInput() {
+		static constexpr struct { int key; InputKey bit; } heldKeys[] = {
+			{ KEY_W, IN_UP }, { KEY_S, IN_DOWN }, { KEY_A, IN_LEFT }, { KEY_D, IN_RIGHT }, { KEY_SPACE, IN_FIRE },
+			{ KEY_BACKSPACE, IN_REWIND },
+		};
+		static constexpr struct { int key; InputKey bit; } pressedKeys[] = {
+			{ KEY_TAB, IN_NEXT_WEAPON }, { KEY_F, IN_NEXT_CHARACTER }, { KEY_E, IN_DETONATE },
+			{ KEY_R, IN_RESTART }, { KEY_T, IN_WATCH_ADD },
+			{ KEY_ONE, IN_SHAPE_1 }, { KEY_TWO, IN_SHAPE_2 }, { KEY_THREE, IN_SHAPE_3 },
+			{ KEY_FOUR, IN_SHAPE_4 }, { KEY_FIVE, IN_SHAPE_5 },
+		};
+		InputState in;
+		for (const auto& k : heldKeys) {
+			if (IsKeyDown(k.key)) in.held |= k.bit;
+		}
+		for (const auto& k : pressedKeys) {
+			if (IsKeyPressed(k.key)) in.pressed |= k.bit;
 		}
+		return in;
 	}
 
-private:
-	Application()
-	{
-		asteroids.reserve(1000);
-		projectiles.reserve(10'000);
-	};
-
-	std::vector<std::unique_ptr<Asteroid>> asteroids;
-	std::vector<Projectile> projectiles;
-	Texture2D textureBackground = { 0 };
-
-	AsteroidShape currentShape = AsteroidShape::GEEBLE;
-	Character currentCharacter = Character::PIBBLE;
+	AssetPack pack;            // before resources, which decode out of it
+	ResourceCache resources;
+	AudioStream audioStream = {};
+	SpriteHandle background;
+	Sprites sprites;
+	EntityBatches batches;
+	DrawQueue queue;
+	FrameArena frameArena{ 64 << 10 };  // transient data of one frame, reset before the next
 
-	static constexpr int shrapnel = 6;
 	static constexpr int C_WIDTH = 800;
 	static constexpr int C_HEIGHT = 800;
 	static constexpr size_t MAX_AST = 150;
-	static constexpr float C_SPAWN_MIN = 0.5f;
-	static constexpr float C_SPAWN_MAX = 3.0f;
-	static constexpr int C_MAX_ASTEROIDS = 1000;
-	static constexpr int C_MAX_PROJECTILES = 10'000;
+	// The arena is this many views wide and high, with this many asteroids spread over it
+	static constexpr int C_ARENA_VIEWS = 16;
+	static constexpr size_t C_ARENA_ASTEROIDS = 4000;
+	static constexpr float C_REWIND_SECONDS = 10.f;   // held BACKSPACE goes back this far
+	static constexpr unsigned C_DECODE_THREADS = 2;   // PNG decoding next to the game loop
+	static constexpr double C_UPLOAD_BUDGET_MS = 2.0; // atlas uploads per frame
+	static constexpr int C_AUDIO_BUFFER_FRAMES = 1024; // per mixer callback, ~23 ms
 };
 
 
 
-int main() {
-	Application::Instance().Run();
+// asteroids [--record file.rep | --replay file.rep] [--tuning file.txt] [--pack file.pak]
+int main(int argc, char** argv) {
+	Application::Options options;
+	for (int i = 1; i < argc; i++) {
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (strcmp(argv[i], "--record") == 0 && value) options.record = argv[++i];
+		else if (strcmp(argv[i], "--replay") == 0 && value) options.replay = argv[++i];
+		else if (strcmp(argv[i], "--tuning") == 0 && value) options.tuning = argv[++i];
+		else if (strcmp(argv[i], "--pack") == 0 && value) options.pack = argv[++i];
+		else {
+			fprintf(stderr, "usage: %s [--record file.rep | --replay file.rep] [--tuning file.txt] [--pack file.pak]\n", argv[0]);
+			return 1;
+		}
+	}
+	Application::Instance().Run(options);
 	return 0;
 }
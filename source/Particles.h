@@ -0,0 +1,190 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+
+#include <raymath.h>
+
+#include "Random.h"
+
+// --- PARTICLES ---
+// Purely visual: particles never collide, never feed back into the game and
+// are left out of World::Checksum. The pool is fixed-capacity structure of
+// arrays allocated once; emitting into a full pool drops the particle (and
+// counts it) rather than growing, so a frame never allocates. Dead particles
+// are replaced by the last live one, the live ones stay densely packed.
+
+// Same byte layout as raylib's Color, the simulation does not include raylib.h
+struct Rgba {
+	uint8_t r, g, b, a;
+};
+
+// How the renderer draws a particle
+enum class ParticleLook : uint8_t { FLAME, SQUARE };
+
+// Appearance and motion over a particle's life; start and end values are lerped by age / life
+struct ParticleStyle {
+	ParticleLook look;
+	Rgba colorStart, colorEnd;
+	float sizeStart, sizeEnd;   // half extents in pixels
+	float drag;                 // fraction of velocity lost per second
+};
+
+// What an emitter spits out: Burst emits burst particles at once, Stream
+// emits rate particles per second for as long as it is called
+struct ParticleEmitter {
+	uint8_t style;              // index into the pool's style table
+	int burst;
+	float rate;
+	float speedMin, speedMax;
+	float lifeMin, lifeMax;     // seconds
+	float spread;               // radians around the direction, 2 PI for every way
+	float radius;               // spawn anywhere within this distance of the position
+	float inherit;              // share of the source's velocity the particles keep
+};
+
+class ParticlePool {
+public:
+	void Init(size_t capacity, const ParticleStyle* styleTable, size_t styleCount, Rng random) {
+		x.assign(capacity, 0.f);
+		y.assign(capacity, 0.f);
+		vx.assign(capacity, 0.f);
+		vy.assign(capacity, 0.f);
+		age.assign(capacity, 0.f);
+		life.assign(capacity, 0.f);
+		rotation.assign(capacity, 0.f);
+		style.assign(capacity, 0);
+		styles.assign(styleTable, styleTable + styleCount);
+		rng = random;
+		count = 0;
+		dropped = 0;
+	}
+
+	void Clear() {
+		count = 0;
+	}
+
+	// n particles at once; direction is an angle in radians
+	void Burst(const ParticleEmitter& e, Vector2 position, Vector2 velocity, float direction, int n) {
+		const size_t emit = std::min(static_cast<size_t>(std::max(n, 0)), x.size() - count);
+		dropped += static_cast<size_t>(std::max(n, 0)) - emit;
+		for (size_t k = 0; k < emit; k++) {
+			const size_t i = count++;
+			const float angle = direction + (rng.Unit() - 0.5f) * e.spread;
+			const float speed = rng.Float(e.speedMin, e.speedMax);
+			const float offset = rng.Unit() * e.radius;
+			const float c = cosf(angle), s = sinf(angle);
+			x[i] = position.x + c * offset;
+			y[i] = position.y + s * offset;
+			vx[i] = velocity.x * e.inherit + c * speed;
+			vy[i] = velocity.y * e.inherit + s * speed;
+			age[i] = 0.f;
+			life[i] = rng.Float(e.lifeMin, e.lifeMax);
+			rotation[i] = rng.Float(0.f, 360.f);
+			style[i] = e.style;
+		}
+	}
+
+	void Burst(const ParticleEmitter& e, Vector2 position, Vector2 velocity = { 0, 0 }, float direction = 0.f) {
+		Burst(e, position, velocity, direction, e.burst);
+	}
+
+	// rate * dt particles, the fraction rounded up or down at random so the
+	// average rate holds without any per-emitter state
+	void Stream(const ParticleEmitter& e, Vector2 position, Vector2 velocity, float direction, float dt) {
+		const float want = e.rate * dt;
+		const int n = static_cast<int>(want);
+		Burst(e, position, velocity, direction, n + (rng.Unit() < want - n ? 1 : 0));
+	}
+
+	void Update(float dt) {
+		const size_t n = count;
+		float* px = x.data();
+		float* py = y.data();
+		float* pvx = vx.data();
+		float* pvy = vy.data();
+		float* pAge = age.data();
+		const uint8_t* pStyle = style.data();
+		float keep[MAX_STYLES];
+		for (size_t s = 0; s < styles.size() && s < MAX_STYLES; s++) {
+			keep[s] = std::max(0.f, 1.f - styles[s].drag * dt);
+		}
+		// Motion and age in one pass over plain arrays
+		for (size_t i = 0; i < n; i++) {
+			px[i] += pvx[i] * dt;
+			py[i] += pvy[i] * dt;
+			const float k = keep[pStyle[i]];
+			pvx[i] *= k;
+			pvy[i] *= k;
+			pAge[i] += dt;
+		}
+		// Then the expired ones, swapped out from the back
+		for (size_t i = 0; i < count;) {
+			if (age[i] < life[i]) {
+				i++;
+				continue;
+			}
+			const size_t last = --count;
+			x[i] = x[last];
+			y[i] = y[last];
+			vx[i] = vx[last];
+			vy[i] = vy[last];
+			age[i] = age[last];
+			life[i] = life[last];
+			rotation[i] = rotation[last];
+			style[i] = style[last];
+		}
+	}
+
+	size_t Size() const {
+		return count;
+	}
+	size_t Capacity() const {
+		return x.size();
+	}
+	// Particles that did not fit since Init
+	size_t Dropped() const {
+		return dropped;
+	}
+
+	const ParticleStyle& Style(uint8_t s) const {
+		return styles[s];
+	}
+
+	const float* X() const {
+		return x.data();
+	}
+	const float* Y() const {
+		return y.data();
+	}
+	const float* VX() const {
+		return vx.data();
+	}
+	const float* VY() const {
+		return vy.data();
+	}
+	const float* Age() const {
+		return age.data();
+	}
+	const float* Life() const {
+		return life.data();
+	}
+	const float* Rotation() const {
+		return rotation.data();
+	}
+	const uint8_t* StyleIndex() const {
+		return style.data();
+	}
+
+	static constexpr size_t MAX_STYLES = 16;
+
+private:
+	std::vector<float> x, y, vx, vy, age, life, rotation;
+	std::vector<uint8_t> style;
+	std::vector<ParticleStyle> styles;
+	Rng rng;
+	size_t count = 0;
+	size_t dropped = 0;
+};
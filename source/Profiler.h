@@ -0,0 +1,268 @@
+#pragma once
+
+// Build with -DPROFILER_ENABLED=0 to compile every PROFILE_ macro out
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+#include <vector>
+#include <memory_resource>
+#include <string>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+// --- PROFILER ---
+// Scoped timers write {zone, thread, begin, end} samples into a fixed ring
+// buffer. Writers only do one fetch_add and a few relaxed stores, from any
+// thread, no locks. Once per frame the main thread folds the new samples into
+// per-zone frame totals (a rolling window for min / avg / p99) and, while a
+// capture is running, keeps them for a Chrome trace (chrome://tracing or
+// ui.perfetto.dev) and a per-frame CSV. Zone totals add up every thread, so a
+// zone that runs on several workers reports CPU time, not wall time.
+class Profiler {
+public:
+	using ZoneId = uint16_t;
+
+	static constexpr size_t HISTORY = 240;  // frames in the rolling window
+
+	struct Stats {
+		const char* name;
+		double minMs, avgMs, p99Ms, lastMs;
+	};
+
+	static Profiler& Instance() {
+		static Profiler inst;
+		return inst;
+	}
+
+	// Once per call site (the macros keep the id in a function-local static)
+	ZoneId RegisterZone(const char* name) {
+		std::lock_guard<std::mutex> lock(zoneMutex);
+		const size_t count = zoneCount.load(std::memory_order_relaxed);
+		for (size_t z = 0; z < count; z++) {
+			if (strcmp(zones[z].name, name) == 0) return static_cast<ZoneId>(z);
+		}
+		if (count == MAX_ZONES) return static_cast<ZoneId>(MAX_ZONES - 1);
+		zones[count].name = name;
+		zoneCount.store(count + 1, std::memory_order_release);
+		return static_cast<ZoneId>(count);
+	}
+
+	static uint64_t Now() {
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	void Record(ZoneId zone, uint64_t beginNs, uint64_t endNs) {
+		const uint64_t index = writeIndex.fetch_add(1, std::memory_order_relaxed);
+		Slot& s = ring[index & (RING_SIZE - 1)];
+		s.seq.store(0, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		s.info.store(static_cast<uint64_t>(zone) | static_cast<uint64_t>(ThreadIndex()) << 16, std::memory_order_relaxed);
+		s.begin.store(beginNs, std::memory_order_relaxed);
+		s.end.store(endNs, std::memory_order_relaxed);
+		s.seq.store(index + 1, std::memory_order_release);
+	}
+
+	// Main thread, once per frame
+	void EndFrame() {
+		const size_t count = zoneCount.load(std::memory_order_acquire);
+		double frameMs[MAX_ZONES] = {};
+		const uint64_t written = writeIndex.load(std::memory_order_acquire);
+		if (written - readIndex > RING_SIZE) {
+			readIndex = written - RING_SIZE;  // overrun, the oldest samples are gone
+		}
+		for (; readIndex < written; readIndex++) {
+			Sample sample;
+			if (!Read(readIndex, sample)) break;  // still being written, pick it up next frame
+			frameMs[sample.zone] += (sample.end - sample.begin) * 1e-6;
+			if (capturing) captured.push_back(sample);
+		}
+		for (size_t z = 0; z < count; z++) {
+			zones[z].history[frame % HISTORY] = frameMs[z];
+		}
+		if (capturing) {
+			capturedFrames.emplace_back(frameMs, frameMs + count);
+		}
+		frame++;
+	}
+
+	// Rolling stats over the last HISTORY frames, in registration order;
+	// pass a frame arena to keep the per-frame overlay off the heap
+	std::pmr::vector<Stats> GetStats(std::pmr::memory_resource* mem = std::pmr::get_default_resource()) const {
+		std::pmr::vector<Stats> out(mem);
+		out.reserve(zoneCount.load(std::memory_order_acquire));
+		const size_t count = zoneCount.load(std::memory_order_acquire);
+		const size_t frames = std::min<size_t>(frame, HISTORY);
+		if (frames == 0) return out;
+		double sorted[HISTORY];
+		for (size_t z = 0; z < count; z++) {
+			std::copy(zones[z].history, zones[z].history + frames, sorted);
+			std::sort(sorted, sorted + frames);
+			double sum = 0.0;
+			for (size_t i = 0; i < frames; i++) {
+				sum += sorted[i];
+			}
+			const size_t p99 = std::min(frames - 1, frames * 99 / 100);
+			out.push_back({ zones[z].name, sorted[0], sum / frames, sorted[p99], zones[z].history[(frame - 1) % HISTORY] });
+		}
+		return out;
+	}
+
+	// Samples and frame totals from now until EndCapture
+	void BeginCapture() {
+		captured.clear();
+		capturedFrames.clear();
+		capturing = true;
+	}
+	bool IsCapturing() const {
+		return capturing;
+	}
+
+	// Writes the capture as Chrome trace JSON and, if csvPath is set, one CSV row per frame
+	bool EndCapture(const char* tracePath, const char* csvPath = nullptr) {
+		capturing = false;
+		bool ok = WriteTrace(tracePath);
+		if (csvPath) ok = WriteCsv(csvPath) && ok;
+		captured.clear();
+		capturedFrames.clear();
+		return ok;
+	}
+
+	class Scope {
+	public:
+		explicit Scope(ZoneId z) : zone(z), begin(Now()) {}
+		~Scope() {
+			Instance().Record(zone, begin, Now());
+		}
+	private:
+		ZoneId zone;
+		uint64_t begin;
+	};
+
+private:
+	Profiler() = default;
+
+	static constexpr size_t RING_SIZE = 1 << 16;  // power of two
+	static constexpr size_t MAX_ZONES = 64;
+
+	struct Sample {
+		ZoneId zone;
+		uint16_t thread;
+		uint64_t begin, end;
+	};
+
+	// seq is index + 1 once the slot holds sample index, 0 while it is being rewritten
+	struct Slot {
+		std::atomic<uint64_t> seq{ 0 };
+		std::atomic<uint64_t> info{ 0 };
+		std::atomic<uint64_t> begin{ 0 };
+		std::atomic<uint64_t> end{ 0 };
+	};
+
+	struct Zone {
+		const char* name = nullptr;
+		double history[HISTORY] = {};
+	};
+
+	bool Read(uint64_t index, Sample& out) const {
+		const Slot& s = ring[index & (RING_SIZE - 1)];
+		if (s.seq.load(std::memory_order_acquire) != index + 1) return false;
+		const uint64_t info = s.info.load(std::memory_order_relaxed);
+		out.begin = s.begin.load(std::memory_order_relaxed);
+		out.end = s.end.load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (s.seq.load(std::memory_order_relaxed) != index + 1) return false;
+		out.zone = static_cast<ZoneId>(info & 0xffff);
+		out.thread = static_cast<uint16_t>(info >> 16);
+		return true;
+	}
+
+	static uint16_t ThreadIndex() {
+		static std::atomic<uint16_t> next{ 0 };
+		thread_local const uint16_t index = next.fetch_add(1);
+		return index;
+	}
+
+	bool WriteTrace(const char* path) const {
+		FILE* f = fopen(path, "w");
+		if (!f) return false;
+		uint64_t origin = UINT64_MAX;
+		for (const Sample& s : captured) {
+			origin = std::min(origin, s.begin);
+		}
+		fprintf(f, "{\"traceEvents\":[\n");
+		for (size_t i = 0; i < captured.size(); i++) {
+			const Sample& s = captured[i];
+			fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}\n",
+				i == 0 ? "" : ",", zones[s.zone].name, static_cast<unsigned>(s.thread),
+				(s.begin - origin) * 1e-3, (s.end - s.begin) * 1e-3);
+		}
+		fprintf(f, "]}\n");
+		return fclose(f) == 0;
+	}
+
+	bool WriteCsv(const char* path) const {
+		FILE* f = fopen(path, "w");
+		if (!f) return false;
+		const size_t count = zoneCount.load(std::memory_order_acquire);
+		fprintf(f, "frame");
+		for (size_t z = 0; z < count; z++) {
+			fprintf(f, ",%s", zones[z].name);
+		}
+		fprintf(f, "\n");
+		for (size_t i = 0; i < capturedFrames.size(); i++) {
+			fprintf(f, "%zu", i);
+			for (size_t z = 0; z < count; z++) {
+				fprintf(f, ",%.4f", z < capturedFrames[i].size() ? capturedFrames[i][z] : 0.0);
+			}
+			fprintf(f, "\n");
+		}
+		return fclose(f) == 0;
+	}
+
+	Slot ring[RING_SIZE];
+	std::atomic<uint64_t> writeIndex{ 0 };
+	uint64_t readIndex = 0;
+
+	Zone zones[MAX_ZONES];
+	std::atomic<size_t> zoneCount{ 0 };
+	std::mutex zoneMutex;
+	uint64_t frame = 0;
+
+	bool capturing = false;
+	std::vector<Sample> captured;
+	std::vector<std::vector<double>> capturedFrames;
+};
+
+// --- STARTUP TIME ---
+// Taken during static initialization, which is as close to process start as
+// portable code gets; startup metrics count from here
+inline const std::chrono::steady_clock::time_point processStart = std::chrono::steady_clock::now();
+
+inline double MsSinceProcessStart() {
+	const std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - processStart;
+	return ms.count();
+}
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#if PROFILER_ENABLED
+// Times the rest of the enclosing block as zone name (a string literal)
+#define PROFILE_SCOPE(name) \
+	static const Profiler::ZoneId PROFILE_CONCAT(profileZone_, __LINE__) = Profiler::Instance().RegisterZone(name); \
+	const Profiler::Scope PROFILE_CONCAT(profileScope_, __LINE__)(PROFILE_CONCAT(profileZone_, __LINE__))
+// A sample timed elsewhere, begin and end from Profiler::Now()
+#define PROFILE_RECORD(zoneId, beginNs, endNs) Profiler::Instance().Record(zoneId, beginNs, endNs)
+#define PROFILE_END_FRAME() Profiler::Instance().EndFrame()
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_RECORD(zoneId, beginNs, endNs) ((void)0)
+#define PROFILE_END_FRAME() ((void)0)
+#endif
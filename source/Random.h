@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// --- RANDOM ---
+// xoshiro128** generators, one per stream. Every stream is seeded from the
+// session seed and its own id through splitmix64, so streams never share
+// state: adding draws to one system does not shift another's sequence, and a
+// worker can own a stream (e.g. one per chunk index) without locking.
+// Same seed, same stream, same numbers on every platform and build.
+
+// Streams of the simulation; append only, renumbering changes every replay
+enum class RngStream : uint32_t {
+	SPAWN,      // asteroid shape, size, edge, heading and spawn interval
+	BENCH,      // populations the benchmark driver injects
+	PARTICLES,  // emission of the (visual only) particles
+	AUDIO,      // noise of the synthesized sound effects
+	COUNT
+};
+
+class Rng {
+public:
+	Rng() : Rng(0, 0) {}
+
+	Rng(uint64_t seed, uint64_t stream) {
+		Seed(seed, stream);
+	}
+
+	Rng(uint64_t seed, RngStream stream) : Rng(seed, static_cast<uint64_t>(stream)) {}
+
+	void Seed(uint64_t seed, uint64_t stream) {
+		uint64_t x = seed ^ (stream * 0xd1b54a32d192ed03ull);
+		const uint64_t a = SplitMix(x), b = SplitMix(x);
+		s[0] = static_cast<uint32_t>(a);
+		s[1] = static_cast<uint32_t>(a >> 32);
+		s[2] = static_cast<uint32_t>(b);
+		s[3] = static_cast<uint32_t>(b >> 32);
+	}
+
+	uint32_t Next() {
+		const uint32_t result = Rotl(s[1] * 5, 7) * 9;
+		const uint32_t t = s[1] << 9;
+		s[2] ^= s[0];
+		s[3] ^= s[1];
+		s[1] ^= s[2];
+		s[0] ^= s[3];
+		s[2] ^= t;
+		s[3] = Rotl(s[3], 11);
+		return result;
+	}
+
+	// [0, 1), 24 bits so every value is exact
+	float Unit() {
+		return static_cast<float>(Next() >> 8) * (1.f / 16777216.f);
+	}
+
+	float Float(float min, float max) {
+		return min + Unit() * (max - min);
+	}
+
+	// Inclusive on both ends, same contract as raylib's GetRandomValue
+	int Int(int min, int max) {
+		const uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(max) - min) + 1;
+		return static_cast<int>(min + static_cast<int64_t>((static_cast<uint64_t>(Next()) * range) >> 32));
+	}
+
+	// n floats in [min, max), the same values n calls to Float would give
+	void Fill(float* out, size_t n, float min, float max) {
+		const float scale = (max - min) * (1.f / 16777216.f);
+		for (size_t i = 0; i < n; i++) {
+			out[i] = min + static_cast<float>(Next() >> 8) * scale;
+		}
+	}
+
+private:
+	static uint32_t Rotl(uint32_t x, int k) {
+		return (x << k) | (x >> (32 - k));
+	}
+
+	static uint64_t SplitMix(uint64_t& x) {
+		uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31);
+	}
+
+	uint32_t s[4];
+};
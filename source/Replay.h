@@ -0,0 +1,235 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+#include "World.h"
+
+// --- INPUT RECORDING ---
+// A replay is everything World::Advance was given, one record per call, plus
+// what the world was created with. Feeding the same records to a world built
+// from the same header and seed reproduces it exactly, whatever the machine's
+// frame rate or thread count, so replays double as regression benchmarks.
+//
+// File layout, little-endian:
+//   header  "ASTR", u16 version, u16 0, u32 seed, i32 width, i32 height,
+//           u32 maxAsteroids, f32 playerRadius, u32 frameCount,
+//           i32 arenaWidth, i32 arenaHeight, u32 arenaAsteroids,
+//           f32 rewindSeconds,
+//           per weapon: f32 fireRate, f32 spacing, f32 radius, i32 damage,
+//                       f32 fuse, i32 fragments
+//           per character: i32 hp, f32 speed
+//   frame   u16 held, u16 pressed, f32 dt                        (8 bytes)
+
+struct ReplayHeader {
+	uint32_t seed = 0;
+	int32_t width = 800;
+	int32_t height = 800;
+	uint32_t maxAsteroids = 150;
+	float playerRadius = 0.f;
+	uint32_t frameCount = 0;
+	int32_t arenaWidth = 0;
+	int32_t arenaHeight = 0;
+	uint32_t arenaAsteroids = 0;
+	float rewindSeconds = 0.f;
+	Tuning tuning;
+
+	static ReplayHeader FromConfig(const World::Config& config) {
+		ReplayHeader h;
+		h.seed = config.seed;
+		h.width = config.width;
+		h.height = config.height;
+		h.maxAsteroids = static_cast<uint32_t>(config.maxAsteroids);
+		h.playerRadius = config.playerRadius;
+		h.arenaWidth = config.arenaWidth;
+		h.arenaHeight = config.arenaHeight;
+		h.arenaAsteroids = static_cast<uint32_t>(config.arenaAsteroids);
+		h.rewindSeconds = config.rewindSeconds;
+		h.tuning = config.tuning;
+		return h;
+	}
+
+	// Everything but threads, which does not change results
+	void Apply(World::Config& config) const {
+		config.seed = seed;
+		config.width = width;
+		config.height = height;
+		config.maxAsteroids = maxAsteroids;
+		config.playerRadius = playerRadius;
+		config.arenaWidth = arenaWidth;
+		config.arenaHeight = arenaHeight;
+		config.arenaAsteroids = arenaAsteroids;
+		config.rewindSeconds = rewindSeconds;
+		config.tuning = tuning;
+	}
+};
+
+class ReplayFile {
+public:
+	~ReplayFile() {
+		Close();
+	}
+
+	bool OpenWrite(const char* path, const ReplayHeader& h) {
+		Close();
+		file = fopen(path, "wb");
+		if (!file) return false;
+		writing = true;
+		header = h;
+		header.frameCount = 0;
+		return WriteHeader();
+	}
+
+	bool OpenRead(const char* path) {
+		Close();
+		file = fopen(path, "rb");
+		if (!file) return false;
+		writing = false;
+		read = 0;
+		uint8_t b[HEADER_SIZE];
+		if (fread(b, 1, HEADER_SIZE, file) != HEADER_SIZE || memcmp(b, MAGIC, 4) != 0 || Get16(b + 4) != VERSION) {
+			Close();
+			return false;
+		}
+		header.seed = Get32(b + 8);
+		header.width = static_cast<int32_t>(Get32(b + 12));
+		header.height = static_cast<int32_t>(Get32(b + 16));
+		header.maxAsteroids = Get32(b + 20);
+		header.playerRadius = GetFloat(b + 24);
+		header.frameCount = Get32(b + 28);
+		header.arenaWidth = static_cast<int32_t>(Get32(b + 32));
+		header.arenaHeight = static_cast<int32_t>(Get32(b + 36));
+		header.arenaAsteroids = Get32(b + 40);
+		header.rewindSeconds = GetFloat(b + 44);
+		const uint8_t* p = b + 48;
+		for (WeaponStats& w : header.tuning.weapons) {
+			w.fireRate = GetFloat(p);
+			w.spacing = GetFloat(p + 4);
+			w.radius = GetFloat(p + 8);
+			w.damage = static_cast<int32_t>(Get32(p + 12));
+			w.fuse = GetFloat(p + 16);
+			w.fragments = static_cast<int32_t>(Get32(p + 20));
+			p += 24;
+		}
+		for (CharacterStats& c : header.tuning.characters) {
+			c.hp = static_cast<int32_t>(Get32(p));
+			c.speed = GetFloat(p + 4);
+			p += 8;
+		}
+		return true;
+	}
+
+	// Patches the frame count into the header of a recording
+	void Close() {
+		if (!file) return;
+		if (writing) {
+			fseek(file, 0, SEEK_SET);
+			WriteHeader();
+		}
+		fclose(file);
+		file = nullptr;
+	}
+
+	bool IsOpen() const {
+		return file != nullptr;
+	}
+
+	const ReplayHeader& Header() const {
+		return header;
+	}
+
+	void Write(const InputState& in, float dt) {
+		uint8_t b[FRAME_SIZE];
+		Put16(b, static_cast<uint16_t>(in.held));
+		Put16(b + 2, static_cast<uint16_t>(in.pressed));
+		PutFloat(b + 4, dt);
+		if (fwrite(b, 1, FRAME_SIZE, file) == FRAME_SIZE) header.frameCount++;
+	}
+
+	// False once every recorded frame has been read
+	bool Next(InputState& in, float& dt) {
+		uint8_t b[FRAME_SIZE];
+		if (read >= header.frameCount || fread(b, 1, FRAME_SIZE, file) != FRAME_SIZE) return false;
+		in.held = Get16(b);
+		in.pressed = Get16(b + 2);
+		dt = GetFloat(b + 4);
+		read++;
+		return true;
+	}
+
+private:
+	static constexpr char MAGIC[4] = { 'A', 'S', 'T', 'R' };
+	// 2: seeds the world's own RNG streams, not rand(); 3: arena size and population;
+	// 4: rewind history length, which decides how far a recorded rewind goes;
+	// 5: the weapon and ship numbers played with
+	static constexpr uint16_t VERSION = 5;
+	static constexpr size_t HEADER_SIZE = 48 + 24 * C_WEAPON_COUNT + 8 * C_CHARACTER_COUNT;
+	static constexpr size_t FRAME_SIZE = 8;
+	static_assert(IN_REWIND <= 0xffff, "input bits must fit the 16-bit fields");
+
+	bool WriteHeader() {
+		uint8_t b[HEADER_SIZE];
+		memcpy(b, MAGIC, 4);
+		Put16(b + 4, VERSION);
+		Put16(b + 6, 0);
+		Put32(b + 8, header.seed);
+		Put32(b + 12, static_cast<uint32_t>(header.width));
+		Put32(b + 16, static_cast<uint32_t>(header.height));
+		Put32(b + 20, header.maxAsteroids);
+		PutFloat(b + 24, header.playerRadius);
+		Put32(b + 28, header.frameCount);
+		Put32(b + 32, static_cast<uint32_t>(header.arenaWidth));
+		Put32(b + 36, static_cast<uint32_t>(header.arenaHeight));
+		Put32(b + 40, header.arenaAsteroids);
+		PutFloat(b + 44, header.rewindSeconds);
+		uint8_t* p = b + 48;
+		for (const WeaponStats& w : header.tuning.weapons) {
+			PutFloat(p, w.fireRate);
+			PutFloat(p + 4, w.spacing);
+			PutFloat(p + 8, w.radius);
+			Put32(p + 12, static_cast<uint32_t>(w.damage));
+			PutFloat(p + 16, w.fuse);
+			Put32(p + 20, static_cast<uint32_t>(w.fragments));
+			p += 24;
+		}
+		for (const CharacterStats& c : header.tuning.characters) {
+			Put32(p, static_cast<uint32_t>(c.hp));
+			PutFloat(p + 4, c.speed);
+			p += 8;
+		}
+		return fwrite(b, 1, HEADER_SIZE, file) == HEADER_SIZE;
+	}
+
+	static void Put16(uint8_t* p, uint16_t v) {
+		p[0] = static_cast<uint8_t>(v);
+		p[1] = static_cast<uint8_t>(v >> 8);
+	}
+	static void Put32(uint8_t* p, uint32_t v) {
+		for (int i = 0; i < 4; i++) {
+			p[i] = static_cast<uint8_t>(v >> (8 * i));
+		}
+	}
+	static void PutFloat(uint8_t* p, float v) {
+		uint32_t u;
+		memcpy(&u, &v, sizeof(u));
+		Put32(p, u);
+	}
+	static uint16_t Get16(const uint8_t* p) {
+		return static_cast<uint16_t>(p[0] | p[1] << 8);
+	}
+	static uint32_t Get32(const uint8_t* p) {
+		return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 | static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+	}
+	static float GetFloat(const uint8_t* p) {
+		const uint32_t u = Get32(p);
+		float v;
+		memcpy(&v, &u, sizeof(v));
+		return v;
+	}
+
+	FILE* file = nullptr;
+	bool writing = false;
+	uint32_t read = 0;
+	ReplayHeader header;
+};
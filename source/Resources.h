@@ -0,0 +1,404 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <initializer_list>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+#include <span>
+
+#include <raylib.h>
+#include <rlgl.h>
+
+#include "AssetPack.h"
+
+// raylib's rtext.c already links in a non-static copy of stb_rect_pack,
+// keep this one private to the translation unit
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-function"
+#endif
+#include "external/stb_rect_pack.h"
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+// --- RESOURCE CACHE ---
+// Every sprite is read from disk once at startup and packed into a single
+// atlas texture (one texture to bind, one mipmap chain).
+// Users Acquire a handle by file name and Release it when done; switching a
+// sprite is just switching handles, nothing goes back to the disk.
+//
+// Loading is asynchronous: BuildAsync packs the atlas from the PNG headers
+// alone, so every sprite has its size and place straight away, then worker
+// threads read and decode the files. The main thread uploads what is decoded
+// with Pump, a few rows at a time within a time budget. Until a sprite is
+// Ready its part of the atlas is undefined and callers draw a placeholder.
+// A cooked copy (name.qoi next to name.png, see Cook.cpp) is read instead of
+// the PNG when there is one; sprites are still acquired by the PNG's name.
+// With an AssetPack, files in it are decoded straight out of the mapping and
+// only the ones it lacks are looked for on disk.
+
+struct SpriteHandle {
+	uint16_t index = UINT16_MAX;
+
+	bool Valid() const {
+		return index != UINT16_MAX;
+	}
+	bool operator==(const SpriteHandle&) const = default;
+};
+
+class ResourceCache {
+public:
+	~ResourceCache() {
+		StopWorkers();
+	}
+
+	// Loads and packs the files before returning, call once after InitWindow
+	void Build(std::initializer_list<const char*> files) {
+		BuildAsync(files, 1);
+		while (!Pump(1e9)) {
+			std::this_thread::yield();
+		}
+	}
+
+	// Packs the files and starts decoding them on decodeThreads worker threads,
+	// call once after InitWindow. pack (optional) has to stay open until
+	// Unload. A file whose header cannot be read is decoded here to learn its
+	// size.
+	void BuildAsync(std::initializer_list<const char*> files, unsigned decodeThreads, const AssetPack* pack = nullptr) {
+		const auto start = std::chrono::steady_clock::now();
+		std::vector<stbrp_rect> rects;
+		int cooked = 0, packed = 0;
+		for (const char* file : files) {
+			int w = 0, h = 0;
+			Entry e = { file, file, {}, {}, 0, {}, 0, false };
+			const bool found = Locate(e, pack, w, h);
+			if (e.path != e.file) cooked++;
+			if (!e.packed.empty()) packed++;
+			if (!found) {
+				w = h = 0;
+				Image image = LoadImage(file);
+				if (image.data != nullptr) {
+					w = image.width;
+					h = image.height;
+					e.pixels = Pad(image);
+				}
+				UnloadImage(image);
+			}
+			stbrp_rect r = {};
+			r.id = static_cast<int>(entries.size());
+			r.w = w > 0 ? w + 2 * PADDING : 0;
+			r.h = h > 0 ? h + 2 * PADDING : 0;
+			rects.push_back(r);
+			entries.push_back(std::move(e));
+		}
+		int size = MIN_SIZE;
+		while (!Pack(rects, size) && size < MAX_SIZE) {
+			size *= 2;
+		}
+		states = std::vector<std::atomic<uint8_t>>(entries.size());
+		for (size_t i = 0; i < entries.size(); i++) {
+			Entry& e = entries[i];
+			if (rects[i].w == 0 || !rects[i].was_packed) {
+				if (rects[i].w != 0) TraceLog(LOG_WARNING, "ATLAS: %s does not fit into %dx%d", e.file.c_str(), size, size);
+				e.pixels.clear();
+				e.settled = true;
+				states[i] = FAILED;
+				continue;
+			}
+			e.source = {
+				static_cast<float>(rects[i].x + PADDING), static_cast<float>(rects[i].y + PADDING),
+				static_cast<float>(rects[i].w - 2 * PADDING), static_cast<float>(rects[i].h - 2 * PADDING)
+			};
+			states[i] = e.pixels.empty() ? QUEUED : DECODED;
+		}
+
+		// Allocated on the GPU without uploading anything; mipmaps come once every sprite is in
+		atlas.id = rlLoadTexture(nullptr, size, size, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, 1);
+		atlas.width = size;
+		atlas.height = size;
+		atlas.mipmaps = 1;
+		atlas.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+		SetTextureFilter(atlas, TEXTURE_FILTER_BILINEAR);
+		pending = 0;
+		for (const Entry& e : entries) {
+			if (!e.settled) pending++;
+		}
+		finished = false;
+		nextDecode = 0;
+		stop = false;
+		for (unsigned t = 0; t < std::max(1u, decodeThreads); t++) {
+			workers.emplace_back([this] { DecodeLoop(); });
+		}
+		std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+		TraceLog(LOG_INFO, "ATLAS: %d sprites (%d packed, %d cooked) placed into %dx%d in %.2f ms, decoding on %u thread(s)",
+			static_cast<int>(entries.size()), packed, cooked, size, size, ms.count(), std::max(1u, decodeThreads));
+	}
+
+	// Uploads decoded sprites for up to budgetMs, at least one strip of rows per
+	// call. Returns true once every sprite is in and the mipmaps are built.
+	bool Pump(double budgetMs) {
+		if (finished) return true;
+		const auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < entries.size() && pending > 0; i++) {
+			Entry& e = entries[i];
+			if (e.settled) continue;
+			const uint8_t state = states[i].load(std::memory_order_acquire);
+			if (state == FAILED) {
+				e.settled = true;
+				pending--;
+				continue;
+			}
+			if (state != DECODED) continue;
+			const int w = static_cast<int>(e.source.width) + 2 * PADDING;
+			const int h = static_cast<int>(e.source.height) + 2 * PADDING;
+			while (e.uploadedRows < h) {
+				const int rows = std::min(UPLOAD_ROWS, h - e.uploadedRows);
+				const Rectangle rect = {
+					e.source.x - PADDING, e.source.y - PADDING + e.uploadedRows,
+					static_cast<float>(w), static_cast<float>(rows)
+				};
+				UpdateTextureRec(atlas, rect, e.pixels.data() + static_cast<size_t>(e.uploadedRows) * w);
+				e.uploadedRows += rows;
+				std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+				if (e.uploadedRows < h && ms.count() >= budgetMs) return false;
+			}
+			std::vector<Color>().swap(e.pixels);
+			states[i].store(READY, std::memory_order_relaxed);
+			e.settled = true;
+			pending--;
+			std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+			if (pending > 0 && ms.count() >= budgetMs) return false;
+		}
+		if (pending > 0) return false;
+		StopWorkers();
+		GenTextureMipmaps(&atlas);
+		SetTextureFilter(atlas, TEXTURE_FILTER_TRILINEAR);
+		finished = true;
+		TraceLog(LOG_INFO, "ATLAS: every sprite uploaded");
+		return true;
+	}
+
+	// Whether the sprite is in the atlas; invalid and failed sprites never are
+	bool Ready(SpriteHandle h) const {
+		return h.Valid() && states[h.index].load(std::memory_order_relaxed) == READY;
+	}
+
+	// Sprites still to be uploaded
+	size_t Pending() const {
+		return pending;
+	}
+
+	void Unload() {
+		StopWorkers();
+		for (const Entry& e : entries) {
+			if (e.refs != 0) TraceLog(LOG_WARNING, "ATLAS: %s still has %d reference(s)", e.file.c_str(), e.refs);
+		}
+		entries.clear();
+		states.clear();
+		pending = 0;
+		finished = false;
+		if (atlas.id != 0) UnloadTexture(atlas);
+		atlas = {};
+	}
+
+	// Invalid handle when the file was not part of Build
+	SpriteHandle Acquire(const char* file) {
+		for (size_t i = 0; i < entries.size(); i++) {
+			if (entries[i].file == file) {
+				entries[i].refs++;
+				return { static_cast<uint16_t>(i) };
+			}
+		}
+		TraceLog(LOG_WARNING, "ATLAS: %s was not preloaded", file);
+		return {};
+	}
+
+	void Release(SpriteHandle h) {
+		if (h.Valid() && entries[h.index].refs > 0) entries[h.index].refs--;
+	}
+
+	const Texture2D& Atlas() const {
+		return atlas;
+	}
+
+	// Pixel rect inside the atlas; also the sprite's size
+	Rectangle Source(SpriteHandle h) const {
+		return h.Valid() ? entries[h.index].source : Rectangle{};
+	}
+
+	// Same rect in [0, 1] texture coordinates
+	Rectangle SourceNormalized(SpriteHandle h) const {
+		const Rectangle s = Source(h);
+		const float w = static_cast<float>(atlas.width), hh = static_cast<float>(atlas.height);
+		return { s.x / w, s.y / hh, s.width / w, s.height / hh };
+	}
+
+	// A rect relative to the sprite, in atlas pixels
+	Rectangle AtlasSource(SpriteHandle h, Rectangle source) const {
+		const Rectangle s = Source(h);
+		return { s.x + source.x, s.y + source.y, source.width, source.height };
+	}
+
+	// DrawTexturePro for a sprite, source is relative to the sprite
+	void Draw(SpriteHandle h, Rectangle source, Rectangle dest, Vector2 origin, float rotation, Color tint) const {
+		DrawTexturePro(atlas, AtlasSource(h, source), dest, origin, rotation, tint);
+	}
+
+	// DrawTextureEx for a sprite
+	void Draw(SpriteHandle h, Vector2 position, float scale, Color tint) const {
+		const Rectangle s = Source(h);
+		DrawTexturePro(atlas, s, { position.x, position.y, s.width * scale, s.height * scale }, { 0, 0 }, 0.0f, tint);
+	}
+
+private:
+	struct Entry {
+		std::string file;
+		std::string path;            // what is read: file or its cooked copy
+		std::span<const uint8_t> packed;   // its bytes in the pack, empty when read from disk
+		Rectangle source;
+		int refs;
+		std::vector<Color> pixels;   // decoded and padded, until uploaded
+		int uploadedRows;
+		bool settled;                // READY or FAILED, no longer pending
+	};
+
+	enum State : uint8_t { QUEUED, DECODED, READY, FAILED };
+
+	static int BigEndian32(const uint8_t* p) {
+		return static_cast<int>(p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3]);
+	}
+
+	// Width and height from the start of a PNG (its IHDR chunk) or a QOI file
+	static bool ImageSize(const uint8_t* b, size_t n, int& w, int& h) {
+		static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+		if (n >= 24 && memcmp(b, signature, 8) == 0 && memcmp(b + 12, "IHDR", 4) == 0) {
+			w = BigEndian32(b + 16);
+			h = BigEndian32(b + 20);
+		}
+		else if (n >= 14 && memcmp(b, "qoif", 4) == 0) {
+			w = BigEndian32(b + 4);
+			h = BigEndian32(b + 8);
+		}
+		else {
+			return false;
+		}
+		return w > 0 && h > 0;
+	}
+
+	static bool ReadImageSize(const char* file, int& w, int& h) {
+		FILE* f = fopen(file, "rb");
+		if (!f) return false;
+		uint8_t b[24];
+		const size_t n = fread(b, 1, sizeof(b), f);
+		fclose(f);
+		return ImageSize(b, n, w, h);
+	}
+
+	// name.png -> name.qoi
+	static std::string CookedPath(const char* file) {
+		std::string path = file;
+		const size_t dot = path.find_last_of('.');
+		if (dot != std::string::npos && path.find_first_of("/\\", dot) == std::string::npos) path.resize(dot);
+		return path + ".qoi";
+	}
+
+	// Picks what to read for e.file and its size: the pack before the disk,
+	// a cooked copy before the PNG. False when none of them has a header.
+	static bool Locate(Entry& e, const AssetPack* pack, int& w, int& h) {
+		const std::string candidates[2] = { CookedPath(e.file.c_str()), e.file };
+		if (pack && pack->IsOpen()) {
+			for (const std::string& name : candidates) {
+				const std::span<const uint8_t> bytes = pack->Find(name);
+				if (!bytes.empty() && ImageSize(bytes.data(), bytes.size(), w, h)) {
+					e.path = name;
+					e.packed = bytes;
+					return true;
+				}
+			}
+		}
+		for (const std::string& name : candidates) {
+			if (ReadImageSize(name.c_str(), w, h)) {
+				e.path = name;
+				return true;
+			}
+		}
+		e.path = e.file;
+		return false;
+	}
+
+	// RGBA pixels with the border repeated PADDING wide, so filtering and
+	// lower mips do not pull in the neighbours
+	static std::vector<Color> Pad(Image& image) {
+		ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+		const int w = image.width + 2 * PADDING;
+		std::vector<Color> pixels(static_cast<size_t>(w) * (image.height + 2 * PADDING));
+		const Color* src = static_cast<const Color*>(image.data);
+		for (int y = -PADDING; y < image.height + PADDING; y++) {
+			const int sy = std::clamp(y, 0, image.height - 1);
+			Color* dst = &pixels[static_cast<size_t>(y + PADDING) * w + PADDING];
+			for (int x = -PADDING; x < image.width + PADDING; x++) {
+				dst[x] = src[sy * image.width + std::clamp(x, 0, image.width - 1)];
+			}
+		}
+		return pixels;
+	}
+
+	// Worker: takes the next queued file until none are left. Only the entry's
+	// pixels are written here, published by its state.
+	void DecodeLoop() {
+		for (;;) {
+			const size_t i = nextDecode.fetch_add(1);
+			if (i >= entries.size() || stop) return;
+			if (states[i].load(std::memory_order_relaxed) != QUEUED) continue;
+			Entry& e = entries[i];
+			// Straight from the mapping, the decoder's output is the only copy
+			Image image = e.packed.empty() ? LoadImage(e.path.c_str()) :
+				LoadImageFromMemory(GetFileExtension(e.path.c_str()), e.packed.data(), static_cast<int>(e.packed.size()));
+			const bool fits = image.data != nullptr && image.width == static_cast<int>(e.source.width) &&
+				image.height == static_cast<int>(e.source.height);
+			if (fits) e.pixels = Pad(image);
+			UnloadImage(image);
+			if (!fits) TraceLog(LOG_WARNING, "ATLAS: %s could not be decoded", e.path.c_str());
+			states[i].store(fits ? DECODED : FAILED, std::memory_order_release);
+		}
+	}
+
+	void StopWorkers() {
+		stop = true;
+		for (std::thread& t : workers) {
+			t.join();
+		}
+		workers.clear();
+	}
+
+	static bool Pack(std::vector<stbrp_rect>& rects, int size) {
+		std::vector<stbrp_node> nodes(size);
+		stbrp_context context;
+		stbrp_init_target(&context, size, size, nodes.data(), size);
+		return stbrp_pack_rects(&context, rects.data(), static_cast<int>(rects.size())) != 0;
+	}
+
+	static constexpr int PADDING = 4;
+	static constexpr int MIN_SIZE = 512;
+	static constexpr int MAX_SIZE = 8192;
+	static constexpr int UPLOAD_ROWS = 64;   // rows per UpdateTextureRec
+
+	std::vector<Entry> entries;
+	std::vector<std::atomic<uint8_t>> states;  // per entry, a State
+	std::atomic<size_t> nextDecode{ 0 };
+	std::atomic<bool> stop{ false };
+	std::vector<std::thread> workers;
+	size_t pending = 0;    // sprites not yet READY or FAILED
+	bool finished = false; // everything settled and the mipmaps built
+	Texture2D atlas = { 0 };
+};
@@ -0,0 +1,269 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <cstdint>
+#include <cstring>
+
+// --- SNAPSHOTS ---
+// The simulation state as one flat byte buffer: trivially copyable values and
+// arrays of them, copied with memcpy in the order they are written. Native
+// layout and byte order, so a snapshot is only good for the build that took
+// it (replays are the portable format). Writing into a buffer that already
+// has the capacity and reading into containers that already have it do not
+// allocate.
+
+class SnapshotWriter {
+public:
+	// Overwrites out from the start
+	explicit SnapshotWriter(std::vector<uint8_t>& out) : buffer(out) {
+		buffer.clear();
+	}
+
+	template <typename T>
+	void Pod(const T& value) {
+		static_assert(std::is_trivially_copyable_v<T>, "snapshots hold plain bytes");
+		Bytes(&value, sizeof(T));
+	}
+
+	// Element count, then the elements
+	template <typename T>
+	void Array(const std::vector<T>& values) {
+		static_assert(std::is_trivially_copyable_v<T>, "snapshots hold plain bytes");
+		Pod(static_cast<uint32_t>(values.size()));
+		Bytes(values.data(), values.size() * sizeof(T));
+	}
+
+	void Bytes(const void* data, size_t size) {
+		const size_t at = buffer.size();
+		buffer.resize(at + size);
+		if (size) memcpy(buffer.data() + at, data, size);
+	}
+
+	// Pads to a whole number of 8-byte words, which RewindBuffer works in
+	void Finish() {
+		buffer.resize((buffer.size() + 7) & ~size_t(7), 0);
+	}
+
+private:
+	std::vector<uint8_t>& buffer;
+};
+
+// Reads back what a SnapshotWriter wrote. A read past the end fails, and so
+// does every read after it; check Ok() once at the end.
+class SnapshotReader {
+public:
+	SnapshotReader(const uint8_t* data, size_t size) : at(data), end(data + size) {}
+
+	explicit SnapshotReader(const std::vector<uint8_t>& buffer) : SnapshotReader(buffer.data(), buffer.size()) {}
+
+	template <typename T>
+	bool Pod(T& value) {
+		static_assert(std::is_trivially_copyable_v<T>, "snapshots hold plain bytes");
+		return Bytes(&value, sizeof(T));
+	}
+
+	template <typename T>
+	bool Array(std::vector<T>& values) {
+		static_assert(std::is_trivially_copyable_v<T>, "snapshots hold plain bytes");
+		uint32_t count = 0;
+		if (!Pod(count) || static_cast<size_t>(end - at) < count * sizeof(T)) return Fail();
+		values.resize(count);
+		return Bytes(values.data(), count * sizeof(T));
+	}
+
+	bool Bytes(void* data, size_t size) {
+		if (!ok || static_cast<size_t>(end - at) < size) return Fail();
+		if (size) memcpy(data, at, size);
+		at += size;
+		return true;
+	}
+
+	bool Ok() const {
+		return ok;
+	}
+
+private:
+	bool Fail() {
+		ok = false;
+		return false;
+	}
+
+	const uint8_t* at;
+	const uint8_t* end;
+	bool ok = true;
+};
+
+// --- REWIND BUFFER ---
+// The last few snapshots, newest first. Only the newest is kept whole (the
+// head); every older one is stored as its XOR against the next newer one,
+// with the runs of zero words (everything that did not change) squeezed out.
+// Stepping back one snapshot is then a single delta applied to the head,
+// and dropping the oldest never touches the others.
+// The deltas share one pool allocated up front, written round like a ring;
+// when a new delta does not fit, the oldest ones make room. Pushing therefore
+// only allocates while the snapshots themselves are growing.
+class RewindBuffer {
+public:
+	// At most capacity snapshots besides the head, their deltas in poolBytes
+	void Init(size_t capacity, size_t poolBytes) {
+		entries.assign(capacity, {});
+		pool.assign(poolBytes / sizeof(uint32_t), 0);
+		Clear();
+	}
+
+	void Clear() {
+		head.clear();
+		first = 0;
+		count = 0;
+	}
+
+	size_t Capacity() const {
+		return entries.size();
+	}
+	// Snapshots that can still be stepped back to
+	size_t Size() const {
+		return count;
+	}
+	bool Empty() const {
+		return head.empty();
+	}
+	// Bytes held, head and deltas
+	size_t Bytes() const {
+		size_t bytes = head.size();
+		for (size_t k = 0; k < count; k++) {
+			bytes += Oldest(k).words * sizeof(uint32_t);
+		}
+		return bytes;
+	}
+
+	// The newest snapshot
+	const std::vector<uint8_t>& Head() const {
+		return head;
+	}
+
+	// Makes state (a finished snapshot) the newest; the previous newest is kept
+	// as a delta, pushing out the oldest when the ring or the pool is full
+	void Push(const std::vector<uint8_t>& state) {
+		if (!head.empty() && !entries.empty()) {
+			Pack(head, state, packed);
+			Store(packed, head.size());
+		}
+		head.assign(state.begin(), state.end());
+	}
+
+	// Turns the head back into the snapshot before it; false when there is none
+	bool Back() {
+		if (count == 0) return false;
+		count--;
+		const Entry& e = entries[(first + count) % entries.size()];
+		Unpack(pool.data() + e.offset, e.words, e.size, head);
+		return true;
+	}
+
+private:
+	// A delta in the pool: runs of { zero words, literal words, literals... }
+	// in 32-bit halves
+	struct Entry {
+		size_t offset = 0;
+		size_t words = 0;
+		size_t size = 0;   // bytes of the older snapshot
+	};
+
+	// k-th oldest
+	const Entry& Oldest(size_t k) const {
+		return entries[(first + k) % entries.size()];
+	}
+
+	void DropOldest() {
+		first = (first + 1) % entries.size();
+		count--;
+	}
+
+	void Store(const std::vector<uint32_t>& delta, size_t size) {
+		const size_t words = delta.size();
+		if (words > pool.size()) {
+			// No room even alone: the history starts over from the head
+			first = 0;
+			count = 0;
+			return;
+		}
+		size_t at = 0;
+		if (count > 0) {
+			const Entry& newest = Oldest(count - 1);
+			at = newest.offset + newest.words;
+			if (at + words > pool.size()) at = 0;
+		}
+		auto overlaps = [&] {
+			for (size_t k = 0; k < count; k++) {
+				const Entry& e = Oldest(k);
+				if (e.offset < at + words && at < e.offset + e.words) return true;
+			}
+			return false;
+		};
+		while (count > 0 && (count == entries.size() || overlaps())) {
+			DropOldest();
+		}
+		entries[(first + count) % entries.size()] = { at, words, size };
+		if (words) memcpy(pool.data() + at, delta.data(), words * sizeof(uint32_t));
+		count++;
+	}
+
+	static uint64_t Word(const std::vector<uint8_t>& v, size_t i) {
+		uint64_t w = 0;
+		if (i * 8 < v.size()) memcpy(&w, v.data() + i * 8, 8);
+		return w;
+	}
+
+	static void Pack(const std::vector<uint8_t>& older, const std::vector<uint8_t>& newer, std::vector<uint32_t>& out) {
+		const size_t words = std::max(older.size(), newer.size()) / 8;
+		out.clear();
+		constexpr size_t NO_RUN = SIZE_MAX;
+		size_t run = NO_RUN;   // header of the literal run being written
+		uint32_t zeros = 0;
+		for (size_t i = 0; i < words; i++) {
+			const uint64_t x = Word(older, i) ^ Word(newer, i);
+			if (x == 0) {
+				run = NO_RUN;
+				zeros++;
+				continue;
+			}
+			if (run == NO_RUN) {
+				run = out.size();
+				out.push_back(zeros);
+				out.push_back(0);
+				zeros = 0;
+			}
+			out[run + 1]++;
+			out.push_back(static_cast<uint32_t>(x));
+			out.push_back(static_cast<uint32_t>(x >> 32));
+		}
+	}
+
+	static void Unpack(const uint32_t* packed, size_t words, size_t size, std::vector<uint8_t>& state) {
+		state.resize(std::max(state.size(), size), 0);
+		uint8_t* out = state.data();
+		size_t word = 0;
+		for (size_t p = 0; p + 1 < words;) {
+			word += packed[p];
+			const uint32_t literals = packed[p + 1];
+			p += 2;
+			for (uint32_t k = 0; k < literals; k++, word++, p += 2) {
+				const uint64_t x = packed[p] | static_cast<uint64_t>(packed[p + 1]) << 32;
+				uint64_t w;
+				memcpy(&w, out + word * 8, 8);
+				w ^= x;
+				memcpy(out + word * 8, &w, 8);
+			}
+		}
+		state.resize(size);
+	}
+
+	std::vector<Entry> entries;
+	std::vector<uint32_t> pool;
+	std::vector<uint32_t> packed;   // the delta being pushed
+	std::vector<uint8_t> head;
+	size_t first = 0;
+	size_t count = 0;
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+
+#include <raymath.h>
+
+// --- SPATIAL GRID ---
+// Uniform grid broadphase, rebuilt from scratch every frame.
+// Each item is binned by its center only (counting sort, no per-cell lists),
+// and queries are widened by the largest item radius seen in Build instead.
+// Items outside the covered area are clamped into the border cells, so the
+// area can be moved along with whatever part of a larger world is simulated.
+class SpatialGrid {
+public:
+	void Init(float width, float height, float cellSize) {
+		invCell = 1.f / cellSize;
+		cols = std::max(1, static_cast<int>(ceilf(width * invCell)));
+		rows = std::max(1, static_cast<int>(ceilf(height * invCell)));
+		cellStart.assign(static_cast<size_t>(cols) * rows + 1, 0);
+	}
+
+	// Top left corner of the covered area; set it before Build, not between Build and queries
+	void SetOrigin(Vector2 o) {
+		origin = o;
+	}
+
+	void Build(const Vector2* positions, const float* radii, size_t count) {
+		cellOf.resize(count);
+		items.resize(count);
+		std::fill(cellStart.begin(), cellStart.end(), 0);
+		maxRadius = 0.f;
+
+		for (size_t i = 0; i < count; i++) {
+			uint32_t cell = CellIndex(CellX(positions[i].x), CellY(positions[i].y));
+			cellOf[i] = cell;
+			cellStart[cell + 1]++;
+			maxRadius = std::max(maxRadius, radii[i]);
+		}
+		for (size_t c = 1; c < cellStart.size(); c++) {
+			cellStart[c] += cellStart[c - 1];
+		}
+		cursor.assign(cellStart.begin(), cellStart.end() - 1);
+		for (size_t i = 0; i < count; i++) {
+			items[cursor[cellOf[i]]++] = static_cast<uint32_t>(i);
+		}
+	}
+
+	// Calls fn(index) for every item whose cell may hold something overlapping
+	// the circle. Callers still do the exact test; each item is visited once.
+	template <typename Fn>
+	void Query(Vector2 center, float radius, Fn&& fn) const {
+		QueryBox({ center.x - radius, center.y - radius }, { center.x + radius, center.y + radius }, fn);
+	}
+
+	// Same for an axis-aligned box, e.g. the bounds of a swept circle
+	template <typename Fn>
+	void QueryBox(Vector2 min, Vector2 max, Fn&& fn) const {
+		const int x0 = CellX(min.x - maxRadius), x1 = CellX(max.x + maxRadius);
+		const int y0 = CellY(min.y - maxRadius), y1 = CellY(max.y + maxRadius);
+		for (int y = y0; y <= y1; y++) {
+			for (int x = x0; x <= x1; x++) {
+				const uint32_t cell = CellIndex(x, y);
+				for (uint32_t k = cellStart[cell]; k < cellStart[cell + 1]; k++) {
+					fn(items[k]);
+				}
+			}
+		}
+	}
+
+private:
+	int CellX(float x) const {
+		return std::clamp(static_cast<int>(floorf((x - origin.x) * invCell)), 0, cols - 1);
+	}
+	int CellY(float y) const {
+		return std::clamp(static_cast<int>(floorf((y - origin.y) * invCell)), 0, rows - 1);
+	}
+	uint32_t CellIndex(int x, int y) const {
+		return static_cast<uint32_t>(y * cols + x);
+	}
+
+	Vector2 origin{};
+	float invCell = 1.f;
+	int cols = 1;
+	int rows = 1;
+	float maxRadius = 0.f;
+	std::vector<uint32_t> cellStart; // cells + 1 prefix offsets into items
+	std::vector<uint32_t> cursor;
+	std::vector<uint32_t> cellOf;
+	std::vector<uint32_t> items;
+};
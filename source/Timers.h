@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "Snapshot.h"
+
+// --- TIMER QUEUE ---
+// Events keyed on simulation time in a binary min-heap: scheduling is
+// O(log n) and a frame only touches the events that are due. Events due at
+// the same time fire in the order they were scheduled, so the result never
+// depends on heap layout. There is no cancel; payloads that can go stale
+// (an Entity that died early) are checked by whoever handles them.
+template <typename Payload>
+class TimerQueue {
+public:
+	void Reserve(size_t n) {
+		heap.reserve(n);
+	}
+
+	void Schedule(double time, const Payload& payload) {
+		heap.push_back({ time, nextSeq++, payload });
+		std::push_heap(heap.begin(), heap.end(), Later);
+	}
+
+	// Hands every event due at or before now to fn, earliest first
+	template <typename Fn>
+	void PopExpired(double now, Fn&& fn) {
+		while (!heap.empty() && heap.front().time <= now) {
+			std::pop_heap(heap.begin(), heap.end(), Later);
+			const Payload payload = heap.back().payload;
+			heap.pop_back();
+			fn(payload);
+		}
+	}
+
+	void Clear() {
+		heap.clear();
+	}
+
+	size_t Size() const {
+		return heap.size();
+	}
+
+	void Save(SnapshotWriter& out) const {
+		out.Array(heap);
+		out.Pod(nextSeq);
+	}
+
+	bool Load(SnapshotReader& in) {
+		in.Array(heap);
+		return in.Pod(nextSeq);
+	}
+
+private:
+	struct Event {
+		double time;
+		uint64_t seq;
+		Payload payload;
+	};
+
+	// std heaps are max-heaps, so "less" means fires later
+	static bool Later(const Event& a, const Event& b) {
+		return a.time != b.time ? a.time > b.time : a.seq > b.seq;
+	}
+
+	std::vector<Event> heap;
+	uint64_t nextSeq = 0;
+};
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <array>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+
+// --- TUNING ---
+// Numbers weapons and ships are balanced by, one table row per WeaponType /
+// Character. The defaults are constexpr; a tuning file can override any of
+// them before the world is created. What a weapon does (trails, fuses going
+// off, how it is drawn) is fixed at compile time, only its numbers are here.
+
+// Ship selector
+enum class Character {PIBBLE, WASHINGTON,GMAIL, COUNT};
+// Weapon selector, the last three only come out of other projectiles
+enum class WeaponType { LASER, BULLET, MISSILE,GRENADES,SHRAPNEL,EXMISSILE, EXPLOSION, COUNT};
+
+inline constexpr size_t C_WEAPON_COUNT = static_cast<size_t>(WeaponType::COUNT);
+inline constexpr size_t C_CHARACTER_COUNT = static_cast<size_t>(Character::COUNT);
+
+struct WeaponStats {
+	float fireRate;   // shots per second
+	float spacing;    // px between shots in flight, so speed is spacing * fireRate
+	float radius;     // collider; blasts start at it and grow
+	int damage;
+	float fuse;       // seconds until it goes off, 0 for never
+	int fragments;    // shrapnel thrown when the fuse burns down
+};
+
+struct CharacterStats {
+	int hp;
+	float speed;      // px per second
+};
+
+// Fuses used to be 40 and 5 frames, these are the same times at 60 fps
+inline constexpr std::array<WeaponStats, C_WEAPON_COUNT> defaultWeapons = { {
+	/* LASER     */ { 18.f,  40.f,  5.f, 20, 0.f, 0 },
+	/* BULLET    */ { 22.f,  20.f,  2.f, 10, 0.f, 0 },
+	/* MISSILE   */ { 3.f,  100.f,  5.f, 20, 0.f, 0 },
+	/* GRENADES  */ { 3.f,  100.f,  5.f, 20, 40.f / 60.f, 6 },
+	/* SHRAPNEL  */ { 4.f,   80.f,  5.f, 20, 40.f / 60.f, 0 },
+	/* EXMISSILE */ { 1.f,  100.f, 50.f, 20, 0.f, 0 },
+	/* EXPLOSION */ { 1.f,  100.f, 80.f, 20, 5.f / 60.f, 0 },
+} };
+
+inline constexpr std::array<CharacterStats, C_CHARACTER_COUNT> defaultCharacters = { {
+	/* PIBBLE     */ { 100, 250.f },
+	/* WASHINGTON */ { 50,  400.f },
+	/* GMAIL      */ { 75,  350.f },
+} };
+
+// Names used by tuning files
+inline constexpr const char* weaponNames[C_WEAPON_COUNT] = { "laser", "bullet", "missile", "grenades", "shrapnel", "exmissile", "explosion" };
+inline constexpr const char* characterNames[C_CHARACTER_COUNT] = { "pibble", "washington", "gmail" };
+
+struct Tuning {
+	std::array<WeaponStats, C_WEAPON_COUNT> weapons = defaultWeapons;
+	std::array<CharacterStats, C_CHARACTER_COUNT> characters = defaultCharacters;
+
+	const WeaponStats& Stats(WeaponType type) const {
+		return weapons[static_cast<size_t>(type)];
+	}
+	const CharacterStats& Stats(Character character) const {
+		return characters[static_cast<size_t>(character)];
+	}
+
+	// Speed shots of this weapon leave the ship with
+	float ShotSpeed(WeaponType type) const {
+		return Stats(type).spacing * Stats(type).fireRate;
+	}
+
+	// Overrides entries from a text file, one per line:
+	//   weapon laser fireRate 20
+	//   character gmail hp 90
+	// Blank lines and lines starting with # are skipped. Nothing changes
+	// unless the whole file reads; line (if given) is then the first bad one.
+	bool Load(const char* path, int* line = nullptr) {
+		FILE* f = fopen(path, "r");
+		if (!f) {
+			if (line) *line = 0;
+			return false;
+		}
+		Tuning loaded = *this;
+		char text[256];
+		int at = 0;
+		bool ok = true;
+		while (ok && fgets(text, sizeof(text), f)) {
+			at++;
+			char kind[32], name[32], field[32], value[32];
+			const int read = sscanf(text, "%31s %31s %31s %31s", kind, name, field, value);
+			if (read <= 0 || kind[0] == '#') continue;
+			ok = read == 4 && loaded.Set(kind, name, field, value);
+		}
+		fclose(f);
+		if (!ok) {
+			if (line) *line = at;
+			return false;
+		}
+		*this = loaded;
+		return true;
+	}
+
+private:
+	bool Set(const char* kind, const char* name, const char* field, const char* value) {
+		char* end = nullptr;
+		const float number = strtof(value, &end);
+		if (end == value || *end != '\0') return false;
+		if (strcmp(kind, "weapon") == 0) {
+			const size_t k = Find(weaponNames, name);
+			if (k == C_WEAPON_COUNT) return false;
+			WeaponStats& w = weapons[k];
+			if (strcmp(field, "fireRate") == 0 && number > 0.f) w.fireRate = number;
+			else if (strcmp(field, "spacing") == 0) w.spacing = number;
+			else if (strcmp(field, "radius") == 0 && number >= 0.f) w.radius = number;
+			else if (strcmp(field, "damage") == 0) w.damage = static_cast<int>(number);
+			else if (strcmp(field, "fuse") == 0 && number >= 0.f) w.fuse = number;
+			else if (strcmp(field, "fragments") == 0 && number >= 0.f) w.fragments = static_cast<int>(number);
+			else return false;
+			return true;
+		}
+		if (strcmp(kind, "character") == 0) {
+			const size_t k = Find(characterNames, name);
+			if (k == C_CHARACTER_COUNT) return false;
+			CharacterStats& c = characters[k];
+			if (strcmp(field, "hp") == 0 && number > 0.f) c.hp = static_cast<int>(number);
+			else if (strcmp(field, "speed") == 0) c.speed = number;
+			else return false;
+			return true;
+		}
+		return false;
+	}
+
+	template <size_t N>
+	static size_t Find(const char* const (&names)[N], const char* name) {
+		for (size_t k = 0; k < N; k++) {
+			if (strcmp(names[k], name) == 0) return k;
+		}
+		return N;
+	}
+};
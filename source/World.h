@@ -0,0 +1,1331 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <chrono>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include <bit>
+#include <memory_resource>
+#include <span>
+#include <utility>
+
+#include <raymath.h>
+
+#include "SpatialGrid.h"
+#include "Ecs.h"
+#include "CommandBuffer.h"
+#include "Kernels.h"
+#include "Jobs.h"
+#include "Timers.h"
+#include "Profiler.h"
+#include "Random.h"
+#include "Particles.h"
+#include "FrameArena.h"
+#include "Chunks.h"
+#include "Snapshot.h"
+#include "Tuning.h"
+
+// Simulation core. Nothing in here may touch the raylib window, input or GPU
+// so the same code runs in the game and in the headless benchmark driver.
+
+// --- INPUT ---
+// Snapshot of every key the game reacts to for one frame
+enum InputKey : uint32_t {
+	IN_UP             = 1u << 0,
+	IN_DOWN           = 1u << 1,
+	IN_LEFT           = 1u << 2,
+	IN_RIGHT          = 1u << 3,
+	IN_FIRE           = 1u << 4,
+	IN_NEXT_WEAPON    = 1u << 5,
+	IN_NEXT_CHARACTER = 1u << 6,
+	IN_DETONATE       = 1u << 7,
+	IN_RESTART        = 1u << 8,
+	IN_WATCH_ADD      = 1u << 9,
+	IN_SHAPE_1        = 1u << 10,
+	IN_SHAPE_2        = 1u << 11,
+	IN_SHAPE_3        = 1u << 12,
+	IN_SHAPE_4        = 1u << 13,
+	IN_SHAPE_5        = 1u << 14,
+	IN_REWIND         = 1u << 15,  // held: the world plays its recent past backwards
+};
+
+struct InputState {
+	uint32_t held = 0;    // keys currently down
+	uint32_t pressed = 0; // keys that went down this frame
+
+	bool IsDown(InputKey k) const {
+		return (held & k) != 0;
+	}
+	bool IsPressed(InputKey k) const {
+		return (pressed & k) != 0;
+	}
+};
+
+// Shape selector
+enum class AsteroidShape { TRIANGLE = 3, SQUARE = 4, PENTAGON = 5,GEEBLE=6, RANDOM = 0 };
+// Textures the simulation can refer to; the renderer maps them to GPU textures
+enum class TextureId : uint8_t { NONE, GEEBLE, SPARK_FLAME, COUNT };
+
+// --- TRANSFORM, PHYSICS, LIFETIME, RENDERABLE ---
+struct TransformA {
+	Vector2 position{};
+	float rotation{};
+};
+
+// Transform at the start of the last step, for render interpolation
+struct PrevTransform {
+	Vector2 position{};
+	float rotation{};
+};
+
+struct Physics {
+	Vector2 velocity{};
+	float rotationSpeed{};
+};
+
+struct Renderable {
+	enum Size { SMALL = 1, MEDIUM = 2, LARGE = 4 } size = SMALL;
+};
+
+struct Collider {
+	float radius{};
+};
+
+struct AsteroidData {
+	uint8_t kind{};  // index into asteroidKinds
+	int damage{};    // dealt to the ship on contact
+	float hp{};
+	bool alive = true;
+};
+
+struct ProjectileData {
+	WeaponType type{};
+	int damage{};
+};
+
+using AsteroidArchetype = Archetype<TransformA, PrevTransform, Physics, Renderable, Collider, AsteroidData>;
+using ProjectileArchetype = Archetype<TransformA, PrevTransform, Physics, Collider, ProjectileData>;
+
+// Where to draw something alpha of the way from the previous step to the current one
+inline TransformA Interpolate(const PrevTransform& prev, const TransformA& current, float alpha) {
+	return { Vector2Lerp(prev.position, current.position, alpha), Lerp(prev.rotation, current.rotation, alpha) };
+}
+
+// --- ASTEROID KINDS ---
+struct AsteroidKind {
+	AsteroidShape shape;
+	int sides;          // outline polygon, unused for sprites
+	int baseDamage;     // multiplied by size
+	float radius;       // per size unit
+	TextureId texture;  // NONE draws the outline
+};
+
+inline constexpr AsteroidKind asteroidKinds[] = {
+	{ AsteroidShape::TRIANGLE, 3,  5, 16.f, TextureId::NONE },
+	{ AsteroidShape::SQUARE,   4, 10, 16.f, TextureId::NONE },
+	{ AsteroidShape::PENTAGON, 5, 15, 16.f, TextureId::NONE },
+	// geeble.png is 434 px wide, drawn at 0.2 scale and half size
+	{ AsteroidShape::GEEBLE,   0, 15, 434.f * 0.2f * 0.25f, TextureId::GEEBLE },
+};
+
+// --- PARTICLE STYLES ---
+// Visual effects only; explosions and blasts deal damage through their projectiles
+enum ParticleStyleId : uint8_t { PS_FLAME, PS_SMOKE, PS_SPARK, PS_DEBRIS, PS_COUNT };
+
+inline constexpr ParticleStyle particleStyles[PS_COUNT] = {
+	{ ParticleLook::FLAME,  { 255, 255, 255, 255 }, { 255, 120,  40,   0 }, 22.f, 6.f,  2.5f },
+	{ ParticleLook::FLAME,  { 120, 120, 120, 140 }, {  60,  60,  60,   0 },  8.f, 20.f, 1.5f },
+	{ ParticleLook::SQUARE, { 255, 230, 150, 255 }, { 255,  90,  20,   0 },  1.5f, 1.f, 1.f },
+	{ ParticleLook::SQUARE, { 200, 200, 200, 255 }, { 110, 110, 110,   0 },  2.5f, 1.5f, 0.5f },
+};
+
+// style, burst, rate, speed min / max, life min / max, spread, radius, inherit
+// Explosions are 80 px and last 5/60 s (their fuse): a quick, wide fireball
+static constexpr ParticleEmitter C_EMIT_EXPLOSION = { PS_FLAME, 40, 0.f, 150.f, 450.f, 0.25f, 0.5f, 2 * PI, 20.f, 0.f };
+static constexpr ParticleEmitter C_EMIT_EXPLOSION_SPARKS = { PS_SPARK, 30, 0.f, 200.f, 600.f, 0.2f, 0.6f, 2 * PI, 5.f, 0.f };
+// Missile blasts grow from 50 to 150 px over 1.7 s: a slower cloud that keeps up with the edge
+static constexpr ParticleEmitter C_EMIT_BLAST = { PS_FLAME, 90, 0.f, 40.f, 80.f, 1.f, 1.7f, 2 * PI, 50.f, 0.f };
+static constexpr ParticleEmitter C_EMIT_BLAST_SMOKE = { PS_SMOKE, 30, 0.f, 20.f, 60.f, 1.2f, 2.2f, 2 * PI, 40.f, 0.f };
+// Destroyed asteroids, burst is per size unit
+static constexpr ParticleEmitter C_EMIT_DEBRIS = { PS_DEBRIS, 12, 0.f, 40.f, 160.f, 0.4f, 0.9f, 2 * PI, 8.f, 0.5f };
+// Trails behind missiles, grenades and shrapnel, pointed backwards
+static constexpr ParticleEmitter C_EMIT_TRAIL = { PS_SMOKE, 0, 90.f, 10.f, 40.f, 0.2f, 0.45f, 0.6f, 0.f, 0.f };
+static constexpr ParticleEmitter C_EMIT_TRAIL_SPARKS = { PS_SPARK, 0, 60.f, 30.f, 90.f, 0.1f, 0.25f, 0.8f, 0.f, 0.f };
+
+static constexpr float C_ASTEROID_HP = 20.f;        // per size unit
+static constexpr float C_ASTEROID_SPEED_MIN = 125.f;
+static constexpr float C_ASTEROID_SPEED_MAX = 250.f;
+static constexpr float C_ASTEROID_ROT_MIN = 50.f;
+static constexpr float C_ASTEROID_ROT_MAX = 240.f;
+
+// Factory: just outside an edge of the view, heading across it
+static inline AsteroidArchetype::Row MakeAsteroid(Box view, AsteroidShape shape, Rng& rng) {
+	if (shape == AsteroidShape::RANDOM) {
+		shape = static_cast<AsteroidShape>(3 + rng.Int(0, 2));
+	}
+	const uint8_t kind = static_cast<uint8_t>(static_cast<int>(shape) - 3);
+	TransformA transform;
+	Physics physics;
+	Renderable render;
+
+	// Choose size
+	render.size = static_cast<Renderable::Size>(1 << rng.Int(0, 2));
+	const float radius = asteroidKinds[kind].radius * (float)render.size;
+
+	// Spawn at random edge
+	const float screenW = view.max.x - view.min.x;
+	const float screenH = view.max.y - view.min.y;
+	switch (rng.Int(0, 3)) {
+	case 0:
+		transform.position = { view.min.x + rng.Float(0, screenW), view.min.y - radius };
+		break;
+	case 1:
+		transform.position = { view.max.x + radius, view.min.y + rng.Float(0, screenH) };
+		break;
+	case 2:
+		transform.position = { view.min.x + rng.Float(0, screenW), view.max.y + radius };
+		break;
+	default:
+		transform.position = { view.min.x - radius, view.min.y + rng.Float(0, screenH) };
+		break;
+	}
+
+	// Aim towards center with jitter
+	float maxOff = fminf(screenW, screenH) * 0.1f;
+	float ang = rng.Float(0, 2 * PI);
+	float rad = rng.Float(0, maxOff);
+	const Vector2 mid = { (view.min.x + view.max.x) * 0.5f, (view.min.y + view.max.y) * 0.5f };
+	Vector2 center = {
+									 mid.x + cosf(ang) * rad,
+									 mid.y + sinf(ang) * rad
+	};
+
+	Vector2 dir = Vector2Normalize(Vector2Subtract(center, transform.position));
+	physics.velocity = Vector2Scale(dir, rng.Float(C_ASTEROID_SPEED_MIN, C_ASTEROID_SPEED_MAX));
+	physics.rotationSpeed = rng.Float(C_ASTEROID_ROT_MIN, C_ASTEROID_ROT_MAX);
+
+	transform.rotation = rng.Float(0, 360);
+
+	AsteroidData data;
+	data.kind = kind;
+	data.damage = asteroidKinds[kind].baseDamage * static_cast<int>(render.size);
+	data.hp = C_ASTEROID_HP * (float)render.size;
+	const PrevTransform prev = { transform.position, transform.rotation };
+	return { transform, prev, physics, render, Collider{ radius }, data };
+}
+
+// Anywhere in the arena, heading anywhere: what a large world starts out with
+static inline AsteroidArchetype::Row ScatterAsteroid(Vector2 arena, AsteroidShape shape, Rng& rng) {
+	AsteroidArchetype::Row row = MakeAsteroid({ { 0, 0 }, arena }, shape, rng);
+	TransformA& transform = std::get<TransformA>(row);
+	Physics& physics = std::get<Physics>(row);
+	transform.position = { rng.Float(0, arena.x), rng.Float(0, arena.y) };
+	physics.velocity = Vector2Rotate(physics.velocity, rng.Float(0, 2 * PI));
+	std::get<PrevTransform>(row) = { transform.position, transform.rotation };
+	return row;
+}
+
+// --- PROJECTILES ---
+static constexpr float C_EXMISSILE_GROWTH = 60.f;
+static constexpr float C_EXMISSILE_MAX_RADIUS = 150.f;
+
+inline static ProjectileArchetype::Row MakeProjectile(WeaponType wt, const WeaponStats& stats, const Vector2 pos, Vector2 speed)
+{
+	TransformA transform;
+	transform.position = pos;
+	Physics physics;
+	physics.velocity = speed;
+	ProjectileData data;
+	data.type = wt;
+	data.damage = stats.damage;
+	const PrevTransform prev = { transform.position, transform.rotation };
+	return { transform, prev, physics, Collider{ stats.radius }, data };
+}
+
+// What a weapon does besides flying straight, fixed at compile time so the
+// per-weapon loops below are specialized with no branches on the type.
+// Fuses, blasts and missile detonation go by WeaponStats and their own lists.
+struct WeaponBehavior {
+	bool trail;   // smoke and sparks behind it
+};
+
+inline constexpr WeaponBehavior weaponBehaviors[C_WEAPON_COUNT] = {
+	/* LASER     */ { false },
+	/* BULLET    */ { false },
+	/* MISSILE   */ { true },
+	/* GRENADES  */ { true },
+	/* SHRAPNEL  */ { true },
+	/* EXMISSILE */ { false },
+	/* EXPLOSION */ { false },
+};
+
+// Calls fn.template operator()<W>() once per WeaponType, in enum order
+template <typename Fn>
+inline void ForEachWeaponType(Fn&& fn) {
+	[&]<size_t... W>(std::index_sequence<W...>) {
+		(fn.template operator()<static_cast<WeaponType>(W)>(), ...);
+	}(std::make_index_sequence<C_WEAPON_COUNT>{});
+}
+
+// Projectile rows grouped by weapon, each group in row order, so a per-weapon
+// loop runs over one homogeneous batch. A counting sort, rebuilt once per step.
+class WeaponBatches {
+public:
+	void Build(const ProjectileData* data, size_t n) {
+		uint32_t next[C_WEAPON_COUNT] = {};
+		for (size_t i = 0; i < n; i++) {
+			next[static_cast<size_t>(data[i].type)]++;
+		}
+		uint32_t at = 0;
+		for (size_t w = 0; w < C_WEAPON_COUNT; w++) {
+			start[w] = at;
+			at += next[w];
+			next[w] = start[w];
+		}
+		start[C_WEAPON_COUNT] = at;
+		rows.resize(n);
+		for (size_t i = 0; i < n; i++) {
+			rows[next[static_cast<size_t>(data[i].type)]++] = static_cast<uint32_t>(i);
+		}
+	}
+
+	std::span<const uint32_t> Rows(WeaponType type) const {
+		const size_t w = static_cast<size_t>(type);
+		return { rows.data() + start[w], start[w + 1] - start[w] };
+	}
+
+private:
+	std::vector<uint32_t> rows;
+	uint32_t start[C_WEAPON_COUNT + 1] = {};
+};
+
+// --- SYSTEMS ---
+// Integrate TransformA by Physics through the batch kernel, then queue a kill for every
+// entity that ended up outside bounds, optionally padded by its collider radius.
+// The transform from before the step is kept in PrevTransform.
+// Runs in chunks on the job system; chunks start on a mask byte so none share one.
+static constexpr size_t C_INTEGRATE_GRAIN = 4096;
+static_assert(C_INTEGRATE_GRAIN % 8 == 0, "chunks must not share an out-of-bounds mask byte");
+
+template <typename A, typename Commands>
+static void IntegrateSystem(JobSystem& jobs, A& arch, float dt, Box bounds, bool padByRadius, Commands& commands, std::vector<uint8_t>& mask) {
+	static_assert(sizeof(TransformA) == 3 * sizeof(float) && sizeof(Physics) == 3 * sizeof(float), "kernels view these as float triples");
+	static_assert(sizeof(Collider) == sizeof(float), "kernels view the collider column as floats");
+	static_assert(A::template Has<PrevTransform>, "integrated archetypes are interpolated when drawn");
+	const size_t n = arch.Size();
+	TransformA* transform = arch.template Column<TransformA>();
+	PrevTransform* prev = arch.template Column<PrevTransform>();
+	float* positions = reinterpret_cast<float*>(transform);
+	const float* velocities = reinterpret_cast<const float*>(arch.template Column<Physics>());
+	const float* radii = padByRadius ? reinterpret_cast<const float*>(arch.template Column<Collider>()) : nullptr;
+	mask.resize((n + 7) / 8);
+	jobs.ParallelFor(n, C_INTEGRATE_GRAIN, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			prev[i] = { transform[i].position, transform[i].rotation };
+		}
+		Kernels::Integrate(positions + 3 * begin, velocities + 3 * begin, radii ? radii + begin : nullptr,
+			end - begin, dt, bounds.min.x, bounds.min.y, bounds.max.x, bounds.max.y, mask.data() + begin / 8);
+	});
+	// Kills are queued in row order on the calling thread
+	for (size_t b = 0; b < mask.size(); b++) {
+		for (uint32_t bits = mask[b]; bits != 0; bits &= bits - 1) {
+			commands.Kill(static_cast<uint32_t>(b * 8 + std::countr_zero(bits)));
+		}
+	}
+}
+
+// --- SHIP ---
+class Ship {
+public:
+	Ship(int arenaW, int arenaH, float shipRadius, const CharacterStats& stats) {
+		transform.position = {
+			 arenaW * 0.5f,
+			 arenaH * 0.5f
+		};
+		prevPosition = transform.position;
+		hp = stats.hp;
+		speed = stats.speed;
+		alive = true;
+		radius = shipRadius;
+	}
+
+	void Update(const InputState& in, float dt) {
+		prevPosition = transform.position;
+		if (alive) {
+			if (in.IsDown(IN_UP)) transform.position.y -= speed * dt;
+			if (in.IsDown(IN_DOWN)) transform.position.y += speed * dt;
+			if (in.IsDown(IN_LEFT)) transform.position.x -= speed * dt;
+			if (in.IsDown(IN_RIGHT)) transform.position.x += speed * dt;
+		}
+		else {
+			transform.position.y += speed * dt;
+		}
+	}
+
+	// Keeps the center of the ship inside [0, bounds]
+	void Confine(Vector2 bounds) {
+		transform.position = Vector2Clamp(transform.position, { 0, 0 }, bounds);
+	}
+
+	void SetCharacter(const CharacterStats& stats) {
+		hp = stats.hp;
+		speed = stats.speed;
+	}
+
+	void TakeDamage(int dmg) {
+		if (!alive) return;
+		hp -= dmg;
+		if (hp <= 0) alive = false;
+	}
+	void BuffHp(int hpBuff) {
+		hp += hpBuff;
+	}
+	bool IsAlive() const {
+		return alive;
+	}
+
+	Vector2 GetPosition() const {
+		return transform.position;
+	}
+
+	// Render position alpha of the way through the last step
+	Vector2 GetPosition(float alpha) const {
+		return Vector2Lerp(prevPosition, transform.position, alpha);
+	}
+
+	float GetRadius() const {
+		return radius;
+	}
+
+	int GetHP() const {
+		return hp;
+	}
+
+protected:
+	TransformA transform;
+	Vector2    prevPosition;
+	int        hp;
+	float      speed;
+	bool       alive;
+	float      radius;
+};
+
+// --- CUES ---
+// Things that happened in the simulation which sound (or anything else outside
+// it) may react to. Not simulated state: never saved or hashed.
+struct Cue {
+	enum Kind : uint8_t { PROJECTILE, ASTEROID_DESTROYED };
+	Kind kind;
+	WeaponType weapon;    // PROJECTILE: what appeared, a shot, shrapnel, a blast...
+	Vector2 position;
+};
+
+// --- WORLD ---
+class World {
+public:
+	enum class Phase { INPUT, CHUNKS, SHOOTING, SPAWN, PROJECTILES, BROADPHASE, COLLISIONS, ASTEROIDS, PARTICLES, REWIND, COUNT };
+
+	struct Config {
+		// The view, what fits on screen
+		int width = 800;
+		int height = 800;
+		// Size of the whole world, at least the view's. A larger one scrolls with
+		// the ship and only simulates the chunks around the view in full.
+		int arenaWidth = 0;
+		int arenaHeight = 0;
+		// Asteroids scattered over the whole arena on every (re)start
+		size_t arenaAsteroids = 0;
+		// The spawn timer only adds asteroids around the view while fewer than this are awake
+		size_t maxAsteroids = 150;
+		// Half the on-screen sprite width; every character is scaled to pibb.png * 0.25
+		float playerRadius = 433.f * 0.25f * 0.5f;
+		// Asteroids still hit the ship and are destroyed, but deal no damage (benchmarks)
+		bool invulnerable = false;
+		// Job system size including the calling thread, 0 for one per hardware thread.
+		// Results do not depend on it.
+		unsigned threads = 1;
+		// Session seed; every random stream of the world derives from it
+		uint32_t seed = 0;
+		// Live particle limit, allocated up front
+		size_t maxParticles = 1 << 17;
+		// History IN_REWIND can go back through, 0 records none; crowded worlds
+		// may get less, the deltas share C_REWIND_POOL bytes
+		float rewindSeconds = 0.f;
+		// Weapon and ship numbers, the defaults or a tuning file's
+		Tuning tuning;
+	};
+
+	explicit World(const Config& cfg)
+		: config(cfg), jobs(cfg.threads), spawnRng(cfg.seed, RngStream::SPAWN)
+	{
+		config.arenaWidth = std::max(config.arenaWidth, config.width);
+		config.arenaHeight = std::max(config.arenaHeight, config.height);
+		asteroids.Reserve(1000);
+		projectiles.Reserve(10'000);
+		asteroidCommands.Reserve(64, 1024);
+		projectileCommands.Reserve(1024, 1024);
+		cues.reserve(C_MAX_CUES);
+		chunks.Init(static_cast<float>(config.arenaWidth), static_cast<float>(config.arenaHeight), C_CHUNK_SIZE);
+		// The grid covers the active chunks, which are never more than this
+		const float spanW = (floorf((config.width + 2 * C_ACTIVE_MARGIN) / C_CHUNK_SIZE) + 2) * C_CHUNK_SIZE;
+		const float spanH = (floorf((config.height + 2 * C_ACTIVE_MARGIN) / C_CHUNK_SIZE) + 2) * C_CHUNK_SIZE;
+		grid.Init(std::min(spanW, static_cast<float>(config.arenaWidth)), std::min(spanH, static_cast<float>(config.arenaHeight)), C_GRID_CELL);
+		particles.Init(config.maxParticles, particleStyles, PS_COUNT, Rng(config.seed, RngStream::PARTICLES));
+		if (config.rewindSeconds > 0.f) {
+			rewind.Init(static_cast<size_t>(ceilf(config.rewindSeconds / (C_FIXED_DT * C_REWIND_INTERVAL))), C_REWIND_POOL);
+		}
+		Reset();
+	}
+
+	// New game in the same world; the rewind history is kept, so a restart can be rewound too
+	void Reset() {
+		const CharacterStats& pibble = config.tuning.Stats(Character::PIBBLE);
+		if (player) *player = Ship(config.arenaWidth, config.arenaHeight, config.playerRadius, pibble);
+		else player = std::make_unique<Ship>(config.arenaWidth, config.arenaHeight, config.playerRadius, pibble);
+		asteroids.Clear();
+		chunks.Clear();
+		projectiles.Clear();
+		fuses.Clear();
+		blasts.clear();
+		missiles.clear();
+		particles.Clear();
+		spawnTimer = 0.f;
+		spawnInterval = spawnRng.Float(C_SPAWN_MIN, C_SPAWN_MAX);
+		currentCharacter = Character::PIBBLE;
+		currentWeapon = WeaponType::LASER;
+		chunks.SetActive(ActiveArea(), [](uint32_t) {});
+		for (size_t i = 0; i < config.arenaAsteroids; i++) {
+			const AsteroidArchetype::Row row = ScatterAsteroid(GetArena(), currentShape, spawnRng);
+			Settle({ std::get<TransformA>(row), std::get<Physics>(row), std::get<Renderable>(row),
+				std::get<Collider>(row), std::get<AsteroidData>(row), simTime });
+		}
+	}
+
+	// Simulation rate of the game; Advance feeds Step in these increments
+	static constexpr float C_FIXED_DT = 1.f / 120.f;
+	// Catch-up limit per Advance: after a long hitch the game slows down
+	// instead of spending ever more frames catching up
+	static constexpr int C_MAX_STEPS = 8;
+
+	// Runs the fixed steps that frameDt has made due, returns how many.
+	// Presses are held back until a step runs so each is seen exactly once,
+	// also on frames that are shorter than a step.
+	int Advance(const InputState& in, float frameDt) {
+		accumulator += frameDt;
+		pendingPressed |= in.pressed;
+		int steps = 0;
+		while (accumulator >= C_FIXED_DT && steps < C_MAX_STEPS) {
+			Step({ in.held, pendingPressed }, C_FIXED_DT);
+			pendingPressed = 0;
+			accumulator -= C_FIXED_DT;
+			steps++;
+		}
+		if (accumulator >= C_FIXED_DT) {
+			accumulator = fmodf(accumulator, C_FIXED_DT);
+		}
+		return steps;
+	}
+
+	// Fraction of a step accumulated since the last one, the renderer blends
+	// previous and current transforms by it
+	float GetAlpha() const {
+		return accumulator / C_FIXED_DT;
+	}
+
+	// Advances the simulation by dt seconds using the given input snapshot
+	void Step(const InputState& in, float dt) {
+		stepArena.Reset();
+		rewinding = in.IsDown(IN_REWIND) && rewind.Capacity() > 0;
+		if (rewinding) {
+			ScopedPhase t(*this, Phase::REWIND);
+			StepBack();
+			projectileBatches.Build(projectiles.Column<ProjectileData>(), projectiles.Size());
+			return;
+		}
+		{
+			ScopedPhase t(*this, Phase::INPUT);
+			HandleInput(in, dt);
+		}
+		{
+			ScopedPhase t(*this, Phase::CHUNKS);
+			StreamChunks();
+		}
+		{
+			ScopedPhase t(*this, Phase::SHOOTING);
+			UpdateShooting(in, dt);
+		}
+		{
+			ScopedPhase t(*this, Phase::SPAWN);
+			SpawnAsteroids(dt);
+		}
+		{
+			ScopedPhase t(*this, Phase::PROJECTILES);
+			UpdateProjectiles(dt);
+		}
+		{
+			ScopedPhase t(*this, Phase::BROADPHASE);
+			BuildBroadphase();
+		}
+		{
+			ScopedPhase t(*this, Phase::COLLISIONS);
+			CollideProjectiles(in);
+		}
+		{
+			ScopedPhase t(*this, Phase::ASTEROIDS);
+			UpdateAsteroids(dt);
+		}
+		{
+			ScopedPhase t(*this, Phase::PARTICLES);
+			UpdateParticles(dt);
+		}
+		if (rewind.Capacity() > 0) {
+			ScopedPhase t(*this, Phase::REWIND);
+			RecordRewind();
+		}
+	}
+
+	// Everything Step works from, as a snapshot: ship, asteroids awake and asleep,
+	// projectiles with their fuses, timers and the spawn RNG. Advance's frame
+	// pacing, the rewind history and the (visual only) particles are left out.
+	void Save(std::vector<uint8_t>& buffer) const {
+		SnapshotWriter out(buffer);
+		out.Pod(SNAPSHOT_MAGIC);
+		out.Pod(SNAPSHOT_VERSION);
+		out.Pod(config.arenaWidth);
+		out.Pod(config.arenaHeight);
+		out.Pod(*player);
+		out.Pod(spawnRng);
+		out.Pod(simTime);
+		out.Pod(spawnTimer);
+		out.Pod(spawnInterval);
+		out.Pod(shotTimer);
+		out.Pod(currentWeapon);
+		out.Pod(currentShape);
+		out.Pod(currentCharacter);
+		out.Pod(missilePruneAt);
+		asteroids.Save(out);
+		projectiles.Save(out);
+		fuses.Save(out);
+		out.Array(blasts);
+		out.Array(missiles);
+		chunks.Save(out);
+		out.Finish();
+	}
+
+	// False, with the world untouched, for a snapshot of another version or
+	// arena size; a snapshot cut short restarts the world and is false too
+	bool Load(const std::vector<uint8_t>& buffer) {
+		SnapshotReader in(buffer);
+		uint32_t magic = 0;
+		uint16_t version = 0;
+		int arenaWidth = 0, arenaHeight = 0;
+		in.Pod(magic);
+		in.Pod(version);
+		in.Pod(arenaWidth);
+		in.Pod(arenaHeight);
+		if (!in.Ok() || magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION ||
+			arenaWidth != config.arenaWidth || arenaHeight != config.arenaHeight) {
+			return false;
+		}
+		in.Pod(*player);
+		in.Pod(spawnRng);
+		in.Pod(simTime);
+		in.Pod(spawnTimer);
+		in.Pod(spawnInterval);
+		in.Pod(shotTimer);
+		in.Pod(currentWeapon);
+		in.Pod(currentShape);
+		in.Pod(currentCharacter);
+		in.Pod(missilePruneAt);
+		asteroids.Load(in);
+		projectiles.Load(in);
+		fuses.Load(in);
+		in.Array(blasts);
+		in.Array(missiles);
+		chunks.Load(in);
+		if (!in.Ok()) {
+			Reset();
+			return false;
+		}
+		return true;
+	}
+
+	// Spawns an asteroid immediately, ignoring the spawn timer and maxAsteroids
+	void SpawnAsteroid(AsteroidShape shape) {
+		asteroids.Create(MakeAsteroid(GetView(), shape, spawnRng));
+	}
+
+	// Spawns a projectile immediately, as if something had fired it (stress scenarios)
+	void SpawnProjectile(WeaponType wt, Vector2 pos, Vector2 vel) {
+		OnProjectileSpawned(projectiles.Create(Projectile(wt, pos, vel)), wt);
+	}
+
+	const Config& GetConfig() const {
+		return config;
+	}
+	Ship& GetPlayer() {
+		return *player;
+	}
+	const Ship& GetPlayer() const {
+		return *player;
+	}
+	// The awake ones, in and around the view
+	const AsteroidArchetype& GetAsteroids() const {
+		return asteroids;
+	}
+	// Asteroids in chunks away from the view, moved along now and then but not simulated
+	size_t GetSleepingAsteroids() const {
+		return chunks.Sleeping();
+	}
+	const ProjectileArchetype& GetProjectiles() const {
+		return projectiles;
+	}
+	const ParticlePool& GetParticles() const {
+		return particles;
+	}
+	// Emitting from outside the simulation (stress scenarios)
+	ParticlePool& GetParticles() {
+		return particles;
+	}
+	WeaponType GetCurrentWeapon() const {
+		return currentWeapon;
+	}
+	Character GetCurrentCharacter() const {
+		return currentCharacter;
+	}
+	AsteroidShape GetCurrentShape() const {
+		return currentShape;
+	}
+	// Whether the last Step went back in time instead of forward
+	bool IsRewinding() const {
+		return rewinding;
+	}
+	const RewindBuffer& GetRewind() const {
+		return rewind;
+	}
+	// Projectile rows by weapon as of the end of the last Step
+	const WeaponBatches& GetProjectileBatches() const {
+		return projectileBatches;
+	}
+	// Cues since the last ClearCues, the first C_MAX_CUES of them
+	std::span<const Cue> GetCues() const {
+		return cues;
+	}
+	void ClearCues() {
+		cues.clear();
+	}
+	Vector2 GetArena() const {
+		return { static_cast<float>(config.arenaWidth), static_cast<float>(config.arenaHeight) };
+	}
+	// The part of the world on screen: centered on the ship, kept inside the arena
+	Box GetView() const {
+		return ViewAround(player->GetPosition());
+	}
+	// Same for the ship's render position, alpha of the way through the last step
+	Box GetView(float alpha) const {
+		return ViewAround(player->GetPosition(alpha));
+	}
+	// FNV-1a over everything the collision phases decide: positions, hp, projectile kinds.
+	// Equal checksums after the same input mean the runs did not diverge.
+	uint32_t Checksum() const {
+		uint32_t h = 2166136261u;
+		auto mix = [&h](const void* p, size_t bytes) {
+			const uint8_t* b = static_cast<const uint8_t*>(p);
+			for (size_t i = 0; i < bytes; i++) {
+				h = (h ^ b[i]) * 16777619u;
+			}
+		};
+		for (size_t i = 0; i < asteroids.Size(); i++) {
+			mix(&asteroids.Column<TransformA>()[i], sizeof(TransformA));
+			mix(&asteroids.Column<AsteroidData>()[i].hp, sizeof(float));
+		}
+		for (size_t i = 0; i < projectiles.Size(); i++) {
+			mix(&projectiles.Column<TransformA>()[i], sizeof(TransformA));
+			mix(&projectiles.Column<ProjectileData>()[i].type, sizeof(WeaponType));
+		}
+		chunks.ForEachSleeper([&](const Sleeper& s) {
+			mix(&s.transform, sizeof(TransformA));
+			mix(&s.data.hp, sizeof(float));
+		});
+		const int hp = player->GetHP();
+		mix(&hp, sizeof(hp));
+		return h;
+	}
+
+	unsigned GetThreadCount() const {
+		return jobs.ThreadCount();
+	}
+	// Wall time spent in each phase during the last Step, in milliseconds
+	double GetPhaseMs(Phase p) const {
+		return phaseMs[static_cast<int>(p)];
+	}
+
+	static const char* PhaseName(Phase p) {
+		static const char* names[] = { "input", "chunks", "shooting", "spawn", "projectiles", "broadphase", "collisions", "asteroids", "particles", "rewind" };
+		return names[static_cast<int>(p)];
+	}
+
+private:
+	// An asteroid in a chunk away from the view; asleep it has no previous transform
+	struct Sleeper {
+		TransformA transform;
+		Physics physics;
+		Renderable render;
+		Collider collider;
+		AsteroidData data;
+		double since;   // simTime the transform is up to date with
+	};
+
+	// Always fills phaseMs (benchmarks read it), and feeds the profiler when it is compiled in
+	struct ScopedPhase {
+		ScopedPhase(World& w, Phase p) : world(w), phase(p), start(Profiler::Now()) {}
+		~ScopedPhase() {
+			const uint64_t end = Profiler::Now();
+			world.phaseMs[static_cast<int>(phase)] = (end - start) * 1e-6;
+			PROFILE_RECORD(PhaseZone(phase), start, end);
+		}
+		World& world;
+		Phase phase;
+		uint64_t start;
+	};
+
+	static Profiler::ZoneId PhaseZone(Phase p) {
+		static const auto zones = [] {
+			std::array<Profiler::ZoneId, static_cast<int>(Phase::COUNT)> ids{};
+			for (int i = 0; i < static_cast<int>(Phase::COUNT); i++) {
+				ids[i] = Profiler::Instance().RegisterZone(PhaseName(static_cast<Phase>(i)));
+			}
+			return ids;
+		}();
+		return zones[static_cast<int>(p)];
+	}
+
+	void HandleInput(const InputState& in, float dt) {
+		spawnTimer += dt;
+
+		// Update player
+		player->Update(in, dt);
+		if (player->IsAlive()) {
+			player->Confine(GetArena());
+		}
+		// Restart logic
+		if (!player->IsAlive() && in.IsPressed(IN_RESTART)) {
+			Reset();
+		}
+		// Watching an ad heals; the game shows the ad and stops stepping meanwhile
+		if (in.IsPressed(IN_WATCH_ADD) && player->IsAlive()) {
+			player->BuffHp(C_AD_HP_BUFF);
+		}
+		// Asteroid shape switch
+		if (in.IsPressed(IN_SHAPE_1)) {
+			currentShape = AsteroidShape::TRIANGLE;
+		}
+		if (in.IsPressed(IN_SHAPE_2)) {
+			currentShape = AsteroidShape::SQUARE;
+		}
+		if (in.IsPressed(IN_SHAPE_3)) {
+			currentShape = AsteroidShape::PENTAGON;
+		}
+		if (in.IsPressed(IN_SHAPE_4)) {
+			currentShape = AsteroidShape::RANDOM;
+		}
+		if (in.IsPressed(IN_SHAPE_5)) {
+			currentShape = AsteroidShape::GEEBLE;
+		}
+
+		// Weapon switch
+		if (in.IsPressed(IN_NEXT_WEAPON) && currentCharacter != Character::GMAIL) {
+			currentWeapon = static_cast<WeaponType>((static_cast<int>(currentWeapon) + 1) % (static_cast<int>(WeaponType::COUNT) - 4));
+		}
+
+		//Change charracter
+		if (in.IsPressed(IN_NEXT_CHARACTER) && player->IsAlive())
+		{
+			Character previousCharacter = currentCharacter;
+			currentCharacter = static_cast<Character>((static_cast<int>(currentCharacter) + 1) % static_cast<int>(Character::COUNT));
+			player->SetCharacter(config.tuning.Stats(currentCharacter));
+			if (currentCharacter == Character::GMAIL) {
+				currentWeapon = WeaponType::GRENADES;
+			}
+			else if (previousCharacter == Character::GMAIL) {
+				currentWeapon = WeaponType::LASER;
+			}
+
+		}
+	}
+
+	void UpdateShooting(const InputState& in, float dt) {
+		if (player->IsAlive() && in.IsDown(IN_FIRE)) {
+
+			Vector2 vel = {};
+			shotTimer += dt;
+			const WeaponStats& weapon = config.tuning.Stats(currentWeapon);
+			float interval = 1.f / weapon.fireRate;
+			float projSpeed = config.tuning.ShotSpeed(currentWeapon);
+
+			while (shotTimer >= interval) {
+				Vector2 p = player->GetPosition();
+				p.y -= player->GetRadius();
+				if (currentWeapon != WeaponType::GRENADES)
+				{
+					vel = { 0, -projSpeed };
+					OnProjectileSpawned(projectiles.Create(MakeProjectile(currentWeapon, weapon, p, vel)), currentWeapon);
+				}
+				else
+				{
+					vel = { -cosf(PI / 4) * projSpeed, -sinf(PI / 4) * projSpeed };
+					OnProjectileSpawned(projectiles.Create(MakeProjectile(currentWeapon, weapon, p, vel)), currentWeapon);
+					Vector2 vel2 = { cosf(PI / 4) * projSpeed, -sinf(PI / 4) * projSpeed };
+					OnProjectileSpawned(projectiles.Create(MakeProjectile(currentWeapon, weapon, p, vel2)), currentWeapon);
+				}
+				shotTimer -= interval;
+			}
+		}
+		else {
+			float maxInterval = 1.f / config.tuning.Stats(currentWeapon).fireRate;
+
+			if (shotTimer > maxInterval) {
+				shotTimer = fmodf(shotTimer, maxInterval);
+			}
+		}
+	}
+
+	void SpawnAsteroids(float dt) {
+		if (spawnTimer >= spawnInterval && asteroids.Size() < config.maxAsteroids) {
+			asteroids.Create(MakeAsteroid(GetView(), currentShape, spawnRng));
+			spawnTimer = 0.f;
+			spawnInterval = spawnRng.Float(C_SPAWN_MIN, C_SPAWN_MAX);
+		}
+	}
+
+	// Move them forward and check if in boundries
+	void UpdateProjectiles(float dt) {
+		simTime += dt;
+		// Projectiles end where the simulated part of the world does
+		IntegrateSystem(jobs, projectiles, dt, chunks.ActiveBox(), false, projectileCommands, boundsMask);
+		GrowBlasts(dt);
+		ApplyProjectileCommands();
+	}
+
+	void ApplyProjectileCommands() {
+		projectileCommands.Apply(projectiles, [this](Entity e, const ProjectileArchetype::Row& row) {
+			OnProjectileSpawned(e, std::get<ProjectileData>(row).type);
+		});
+	}
+
+	// Registers whatever a new projectile needs later: its fuse, blast growth or E detonation.
+	// Fuses count from the step the projectile first moves in, like the old per-frame clock.
+	// Explosions and blasts also set off their particles here, wherever they came from.
+	void OnProjectileSpawned(Entity e, WeaponType type) {
+		if (cues.size() < C_MAX_CUES) {
+			cues.push_back({ Cue::PROJECTILE, type, projectiles.Column<TransformA>()[projectiles.RowOf(e)].position });
+		}
+		if (type == WeaponType::EXPLOSION || type == WeaponType::EXMISSILE) {
+			const Vector2 position = projectiles.Column<TransformA>()[projectiles.RowOf(e)].position;
+			if (type == WeaponType::EXPLOSION) {
+				particles.Burst(C_EMIT_EXPLOSION, position);
+				particles.Burst(C_EMIT_EXPLOSION_SPARKS, position);
+			}
+			else {
+				particles.Burst(C_EMIT_BLAST, position);
+				particles.Burst(C_EMIT_BLAST_SMOKE, position);
+			}
+		}
+		const float fuse = config.tuning.Stats(type).fuse;
+		if (fuse > 0.f) {
+			fuses.Schedule(simTime + fuse, { e, type });
+		}
+		if (type == WeaponType::EXMISSILE) {
+			blasts.push_back(e);
+		}
+		else if (type == WeaponType::MISSILE) {
+			// Handles of missiles that died elsewhere pile up until the next E, drop them now and then
+			if (missiles.size() >= missilePruneAt) {
+				std::erase_if(missiles, [this](Entity m) { return !projectiles.IsAlive(m); });
+				missilePruneAt = 2 * missiles.size() + 64;
+			}
+			missiles.push_back(e);
+		}
+	}
+
+	// Missile blasts grow until they reach full size; only live blasts are visited
+	void GrowBlasts(float dt) {
+		Collider* collider = projectiles.Column<Collider>();
+		for (size_t i = 0; i < blasts.size();) {
+			if (!projectiles.IsAlive(blasts[i])) {
+				blasts[i] = blasts.back();
+				blasts.pop_back();
+				continue;
+			}
+			const uint32_t row = projectiles.RowOf(blasts[i]);
+			collider[row].radius += C_EXMISSILE_GROWTH * dt;
+			if (collider[row].radius >= C_EXMISSILE_MAX_RADIUS) {
+				projectileCommands.Kill(row);
+				blasts[i] = blasts.back();
+				blasts.pop_back();
+				continue;
+			}
+			i++;
+		}
+	}
+
+	// Every due fuse: the projectile throws its fragments (grenades: shrapnel) and
+	// goes off in an explosion, explosions just end. Rows consumed here are marked
+	// so they do not also collide.
+	void FireFuses(int* candidateHits) {
+		const Vector2 still = { 0.0f, 0.0f };
+		const TransformA* transform = projectiles.Column<TransformA>();
+		fuses.PopExpired(simTime, [&](const FuseEvent& fuse) {
+			if (!projectiles.IsAlive(fuse.projectile)) return;
+			const uint32_t row = projectiles.RowOf(fuse.projectile);
+			const Vector2 position = transform[row].position;
+			// Fragments fly off as fast as the projectile was launched
+			const int fragments = config.tuning.Stats(fuse.type).fragments;
+			const float projSpeed = config.tuning.ShotSpeed(fuse.type);
+			for (int i = 0; i < fragments; i++) {
+				const float angle = (2 * PI / fragments) * i;
+				Vector2 vel = { cosf(angle) * projSpeed, sinf(angle) * projSpeed };
+				projectileCommands.Spawn(Projectile(WeaponType::SHRAPNEL, position, vel));
+			}
+			if (fuse.type != WeaponType::EXPLOSION) {
+				projectileCommands.Spawn(Projectile(WeaponType::EXPLOSION, position, still));
+			}
+			projectileCommands.Kill(row);
+			candidateHits[row] = CONSUMED;
+		});
+	}
+
+	// E turns every missile in flight into a blast in one go
+	void DetonateMissiles(int* candidateHits) {
+		const Vector2 still = { 0.0f, 0.0f };
+		const TransformA* transform = projectiles.Column<TransformA>();
+		for (Entity e : missiles) {
+			if (!projectiles.IsAlive(e)) continue;
+			const uint32_t row = projectiles.RowOf(e);
+			projectileCommands.Spawn(Projectile(WeaponType::EXMISSILE, transform[row].position, still));
+			projectileCommands.Kill(row);
+			candidateHits[row] = CONSUMED;
+		}
+		missiles.clear();
+	}
+
+	// Bin asteroid centers into the grid. Rows stay valid until UpdateAsteroids
+	// applies its kills: asteroids destroyed in between are only flagged dead.
+	void BuildBroadphase() {
+		const size_t n = asteroids.Size();
+		const TransformA* transform = asteroids.Column<TransformA>();
+		const Collider* collider = asteroids.Column<Collider>();
+		asteroidPos.resize(n);
+		asteroidRadius.resize(n);
+		for (size_t i = 0; i < n; i++) {
+			asteroidPos[i] = transform[i].position;
+			asteroidRadius[i] = collider[i].radius;
+		}
+		grid.SetOrigin(chunks.ActiveBox().min);
+		grid.Build(asteroidPos.data(), asteroidRadius.data(), n);
+	}
+
+	// First live asteroid a circle moving from -> to runs into, or -1. Asteroids
+	// hold still during the collision phase, so this is exact for any step length:
+	// a fast projectile cannot skip over one between two steps. Equal impact times
+	// go to the lowest index, like the old linear scan. Read-only, safe to run in jobs.
+	int FindAsteroidHit(Vector2 from, Vector2 to, float radius) const {
+		const AsteroidData* asteroidData = asteroids.Column<AsteroidData>();
+		int hit = -1;
+		float hitT = 2.f;
+		const Vector2 min = { fminf(from.x, to.x) - radius, fminf(from.y, to.y) - radius };
+		const Vector2 max = { fmaxf(from.x, to.x) + radius, fmaxf(from.y, to.y) + radius };
+		grid.QueryBox(min, max, [&](uint32_t i) {
+			if (!asteroidData[i].alive) return;
+			float t;
+			if (!SweptCircleHit(from, to, asteroidPos[i], radius + asteroidRadius[i], t)) return;
+			if (t < hitT || (t == hitT && static_cast<int>(i) < hit)) {
+				hit = static_cast<int>(i);
+				hitT = t;
+			}
+		});
+		return hit;
+	}
+
+	// Earliest t in [0, 1] at which from + (to - from) * t is closer than reach to
+	// center; 0 when it already starts inside
+	static bool SweptCircleHit(Vector2 from, Vector2 to, Vector2 center, float reach, float& t) {
+		const Vector2 f = Vector2Subtract(from, center);
+		const float c = Vector2DotProduct(f, f) - reach * reach;
+		if (c < 0.f) {
+			t = 0.f;
+			return true;
+		}
+		const Vector2 d = Vector2Subtract(to, from);
+		const float a = Vector2DotProduct(d, d);
+		const float b = Vector2DotProduct(f, d);
+		if (a == 0.f || b >= 0.f) return false;   // not moving, or moving away
+		const float disc = b * b - a * c;
+		if (disc < 0.f) return false;
+		t = (-b - sqrtf(disc)) / a;
+		return t <= 1.f;
+	}
+
+	// Projectile-Asteroid collisions through the grid
+	// Spawns and kills go through projectileCommands and land at the end of the phase,
+	// so projectiles spawned here (shrapnel, explosions) start colliding next frame.
+	// The grid queries run as jobs against the asteroids as they were at the start of
+	// the phase; hits are then applied in projectile order on this thread. Asteroids only
+	// die during the pass, so a candidate that is still alive is exactly what a serial
+	// scan would have found, and a dead one is queried again.
+	// Detonations and due fuses go first and take their projectiles out of the hit pass.
+	void CollideProjectiles(const InputState& in) {
+		const Vector2 still = { 0.0f, 0.0f };
+		const TransformA* transform = projectiles.Column<TransformA>();
+		const PrevTransform* prev = projectiles.Column<PrevTransform>();
+		const Collider* collider = projectiles.Column<Collider>();
+		const ProjectileData* data = projectiles.Column<ProjectileData>();
+		AsteroidData* asteroidData = asteroids.Column<AsteroidData>();
+		const uint32_t n = static_cast<uint32_t>(projectiles.Size());
+		// Per projectile row, or CONSUMED by a fuse or detonation
+		std::pmr::vector<int> candidateHits(n, &stepArena);
+		jobs.ParallelFor(n, C_QUERY_GRAIN, [&](size_t begin, size_t end) {
+			for (size_t pi = begin; pi < end; pi++) {
+				candidateHits[pi] = FindAsteroidHit(prev[pi].position, transform[pi].position, collider[pi].radius);
+			}
+		});
+		if (in.IsPressed(IN_DETONATE)) {
+			DetonateMissiles(candidateHits.data());
+		}
+		FireFuses(candidateHits.data());
+		for (uint32_t pi = 0; pi < n; pi++) {
+			if (candidateHits[pi] == CONSUMED) continue;
+			const WeaponType type = data[pi].type;
+			const Vector2 from = prev[pi].position;
+			const Vector2 to = transform[pi].position;
+			int hit = candidateHits[pi];
+			if (hit >= 0 && !asteroidData[hit].alive) {
+				hit = FindAsteroidHit(from, to, collider[pi].radius);
+			}
+			if (hit >= 0) {
+				AsteroidData& target = asteroidData[hit];
+				target.hp -= data[pi].damage;
+				if (target.hp <= 0) {
+					target.alive = false;
+				}
+				if (type == WeaponType::MISSILE) {
+					// Blast where the missile met the asteroid, not where the step left it
+					float t = 0.f;
+					SweptCircleHit(from, to, asteroidPos[hit], collider[pi].radius + asteroidRadius[hit], t);
+					projectileCommands.Spawn(Projectile(WeaponType::EXMISSILE, Vector2Lerp(from, to, t), still));
+				}
+				projectileCommands.Kill(pi);
+			}
+		}
+		// Sync point
+		ApplyProjectileCommands();
+	}
+
+	// Asteroid-Ship collisions, then move asteroids and drop dead ones and the ones that left the screen
+	void UpdateAsteroids(float dt) {
+		AsteroidData* data = asteroids.Column<AsteroidData>();
+		std::pmr::vector<uint32_t> shipHits(&stepArena);
+		if (player->IsAlive()) {
+			const Vector2 shipPos = player->GetPosition();
+			grid.Query(shipPos, player->GetRadius(), [&](uint32_t i) {
+				const float reach = player->GetRadius() + asteroidRadius[i];
+				if (Vector2DistanceSqr(shipPos, asteroidPos[i]) < reach * reach && data[i].alive) {
+					shipHits.push_back(i);
+				}
+			});
+			// Apply in row order so the ship dies on the same asteroid as a linear scan
+			std::sort(shipHits.begin(), shipHits.end());
+			for (uint32_t i : shipHits) {
+				if (!player->IsAlive()) break;
+				if (!config.invulnerable) player->TakeDamage(data[i].damage);
+				data[i].alive = false; // Mark asteroid for removal due to collision
+			}
+		}
+
+		const uint32_t n = static_cast<uint32_t>(asteroids.Size());
+		const Physics* physics = asteroids.Column<Physics>();
+		const Renderable* render = asteroids.Column<Renderable>();
+		for (uint32_t i = 0; i < n; i++) {
+			if (!data[i].alive) {
+				particles.Burst(C_EMIT_DEBRIS, asteroidPos[i], physics[i].velocity, 0.f, C_EMIT_DEBRIS.burst * static_cast<int>(render[i].size));
+				if (cues.size() < C_MAX_CUES) cues.push_back({ Cue::ASTEROID_DESTROYED, WeaponType::COUNT, asteroidPos[i] });
+				asteroidCommands.Kill(i);
+			}
+		}
+		IntegrateSystem(jobs, asteroids, dt, { { 0, 0 }, GetArena() }, true, asteroidCommands, boundsMask);
+		asteroidCommands.Apply(asteroids);
+	}
+
+	// Projectiles are final for this step: batch them by weapon, lay the trails
+	// behind everything that flies on a fuse or a motor, then the particles move
+	void UpdateParticles(float dt) {
+		projectileBatches.Build(projectiles.Column<ProjectileData>(), projectiles.Size());
+		ForEachWeaponType([&]<WeaponType W>() {
+			UpdateWeapon<W>(projectileBatches.Rows(W), dt);
+		});
+		particles.Update(dt);
+	}
+
+	// Per-weapon visuals over one batch; weapons with nothing to do compile to nothing
+	template <WeaponType W>
+	void UpdateWeapon(std::span<const uint32_t> rows, float dt) {
+		if constexpr (weaponBehaviors[static_cast<size_t>(W)].trail) {
+			const TransformA* transform = projectiles.Column<TransformA>();
+			const Physics* physics = projectiles.Column<Physics>();
+			for (uint32_t i : rows) {
+				const Vector2 v = physics[i].velocity;
+				const float back = atan2f(-v.y, -v.x);
+				particles.Stream(C_EMIT_TRAIL, transform[i].position, v, back, dt);
+				particles.Stream(C_EMIT_TRAIL_SPARKS, transform[i].position, v, back, dt);
+			}
+		}
+	}
+
+	ProjectileArchetype::Row Projectile(WeaponType wt, Vector2 pos, Vector2 vel) const {
+		return MakeProjectile(wt, config.tuning.Stats(wt), pos, vel);
+	}
+
+	Box ViewAround(Vector2 center) const {
+		const Vector2 size = { static_cast<float>(config.width), static_cast<float>(config.height) };
+		const Vector2 min = Vector2Clamp(Vector2Subtract(center, Vector2Scale(size, 0.5f)), { 0, 0 }, Vector2Subtract(GetArena(), size));
+		return { min, Vector2Add(min, size) };
+	}
+
+	// Everything within C_ACTIVE_MARGIN of the view is simulated in full
+	Box ActiveArea() const {
+		const Box view = GetView();
+		return { Vector2SubtractValue(view.min, C_ACTIVE_MARGIN), Vector2AddValue(view.max, C_ACTIVE_MARGIN) };
+	}
+
+	// Every C_REWIND_INTERVAL steps the world goes into the rewind history ...
+	void RecordRewind() {
+		if (++rewindSteps < C_REWIND_INTERVAL) return;
+		rewindSteps = 0;
+		Save(snapshot);
+		rewind.Push(snapshot);
+	}
+
+	// ... and comes back out of it at the same pace while IN_REWIND is held.
+	// The newest snapshot is restored first, then each one before it; at the
+	// oldest the world holds still.
+	void StepBack() {
+		if (++rewindSteps < C_REWIND_INTERVAL) return;
+		rewindSteps = 0;
+		Load(rewind.Head());
+		rewind.Back();
+	}
+
+	// Follows the view with the active chunks: chunks coming into range wake
+	// their sleepers, awake asteroids outside the range fall asleep where they
+	// are, and a few sleeping chunks are brought up to date
+	void StreamChunks() {
+		chunks.SetActive(ActiveArea(), [this](uint32_t c) {
+			chunks.Drain(c, [this](Sleeper& s) { Settle(s); });
+		});
+		if (chunks.AllActive()) return;
+		const TransformA* transform = asteroids.Column<TransformA>();
+		const Physics* physics = asteroids.Column<Physics>();
+		const Renderable* render = asteroids.Column<Renderable>();
+		const Collider* collider = asteroids.Column<Collider>();
+		const AsteroidData* data = asteroids.Column<AsteroidData>();
+		const uint32_t n = static_cast<uint32_t>(asteroids.Size());
+		for (uint32_t i = 0; i < n; i++) {
+			const uint32_t c = chunks.ChunkAt(transform[i].position);
+			if (!chunks.IsActive(c)) {
+				chunks.Put(c, { transform[i], physics[i], render[i], collider[i], data[i], simTime });
+				asteroidCommands.Kill(i);
+			}
+		}
+		asteroidCommands.Apply(asteroids);
+		chunks.TickSome(C_DORMANT_TICKS, [this](Sleeper& s) { Settle(s); });
+	}
+
+	// Moves a sleeper in a straight line up to now, then files it where it ended
+	// up: awake in an active chunk, asleep in another, or gone if it left the arena
+	void Settle(Sleeper s) {
+		TransformA& transform = s.transform;
+		const float elapsed = static_cast<float>(simTime - s.since);
+		transform.position = Vector2Add(transform.position, Vector2Scale(s.physics.velocity, elapsed));
+		transform.rotation += s.physics.rotationSpeed * elapsed;
+		s.since = simTime;
+		const float pad = s.collider.radius;
+		const Vector2 arena = GetArena();
+		if (transform.position.x < -pad || transform.position.x > arena.x + pad ||
+			transform.position.y < -pad || transform.position.y > arena.y + pad) {
+			return;
+		}
+		const uint32_t c = chunks.ChunkAt(transform.position);
+		if (chunks.IsActive(c)) {
+			asteroids.Create(transform, { transform.position, transform.rotation }, s.physics, s.render, s.collider, s.data);
+		}
+		else {
+			chunks.Put(c, s);
+		}
+	}
+
+	Config config;
+	JobSystem jobs;
+	Rng spawnRng;
+	std::unique_ptr<Ship> player;
+	AsteroidArchetype asteroids;
+	ProjectileArchetype projectiles;
+	CommandBuffer<AsteroidArchetype> asteroidCommands;
+	CommandBuffer<ProjectileArchetype> projectileCommands;
+
+	ChunkMap<Sleeper> chunks;
+
+	SpatialGrid grid;
+	std::vector<Vector2> asteroidPos;
+	std::vector<float> asteroidRadius;
+	FrameArena stepArena{ C_STEP_ARENA };  // scratch that lives for one Step
+
+	RewindBuffer rewind;
+	std::vector<uint8_t> snapshot;     // the last Save for the rewind history
+	int rewindSteps = 0;
+	bool rewinding = false;
+
+	struct FuseEvent {
+		Entity projectile;
+		WeaponType type;
+	};
+	TimerQueue<FuseEvent> fuses;
+	std::vector<Entity> blasts;        // growing EXMISSILEs
+	std::vector<Entity> missiles;      // MISSILEs for E, may hold dead handles
+	WeaponBatches projectileBatches;
+	size_t missilePruneAt = 64;
+	std::vector<Cue> cues;
+	double simTime = 0.0;
+	std::vector<uint8_t> boundsMask;
+	ParticlePool particles;
+
+	float spawnTimer = 0.f;
+	float spawnInterval = 0.f;
+	float shotTimer = 0.f;
+	float accumulator = 0.f;
+	uint32_t pendingPressed = 0;
+	WeaponType currentWeapon = WeaponType::LASER;
+	AsteroidShape currentShape = AsteroidShape::GEEBLE;
+	Character currentCharacter = Character::PIBBLE;
+
+	double phaseMs[static_cast<int>(Phase::COUNT)] = {};
+
+	static constexpr int C_AD_HP_BUFF = 20;
+	static constexpr float C_SPAWN_MIN = 0.5f;
+	static constexpr float C_SPAWN_MAX = 3.0f;
+	static constexpr float C_GRID_CELL = 128.f;
+	static constexpr size_t C_QUERY_GRAIN = 512;
+	static constexpr int CONSUMED = -2;
+	static constexpr size_t C_STEP_ARENA = 1 << 20;
+	static constexpr float C_CHUNK_SIZE = 1024.f;
+	static constexpr float C_ACTIVE_MARGIN = 512.f;
+	static constexpr size_t C_DORMANT_TICKS = 16;   // sleeping chunks caught up per step
+	static constexpr int C_REWIND_INTERVAL = 4;     // steps between rewind snapshots
+	static constexpr size_t C_REWIND_POOL = 64 << 20;  // deltas beyond it shorten the history
+	static constexpr uint32_t SNAPSHOT_MAGIC = 0x504e5341;  // "ASNP"
+	static constexpr uint16_t SNAPSHOT_VERSION = 2;   // 2: ship stats live in Tuning
+	static constexpr size_t C_MAX_CUES = 256;   // kept between ClearCues, later ones are lost
+};